@@ -1,18 +1,19 @@
 #ifndef APU_HPP
 #define APU_HPP
 
+#include "AudioChannel.hpp"
+#include "BlipBuffer.hpp"
+#include "DmcChannel.hpp"
+#include "NoiseChannel.hpp"
+#include "PulseChannel.hpp"
+#include "Resampler.hpp"
+#include "TriangleChannel.hpp"
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
-#include <memory>
 #include <optional>
 
-class AudioChannel;
-class DmcChannel;
-class NoiseChannel;
-class PulseChannel;
-class TriangleChannel;
-
 class APU
 {
 public:
@@ -20,15 +21,19 @@ public:
     ~APU() = default;
 
     void Clock();
+    void Run(size_t cycles);
     void Reset();
 
-    int16_t GetSample();
+    void SetAudioRates(double clockRate, double sampleRate);
+    size_t CyclesUntilSamples(size_t count);
+    size_t ReadSamples(int16_t* buffer, size_t count);
 
     uint8_t ReadReg(uint16_t addr);
     void WriteReg(uint16_t addr, uint8_t data);
 
     bool IRQ();
     std::optional<uint16_t> DmcRequestSample();
+    size_t CyclesUntilEvent();
     void SetDmcSample(uint8_t sample);
 
     void Serialize(std::ofstream& saveState);
@@ -49,25 +54,69 @@ private:
     int frameCounterTimer_;
     int frameCounterResetCountdown_;
 
+    static constexpr std::array<int, 5> FRAME_COUNTER_STEPS = {3728, 7456, 11185, 14915, 18641};
+
     void ClockFrameCounter();
+    size_t CyclesUntilFrameCounterStep() const;
 
 // Channels
 private:
-    std::array<std::unique_ptr<AudioChannel>, 4> CHANNELS_;
-    PulseChannel* pulseChannel1_;
-    PulseChannel* pulseChannel2_;
-    TriangleChannel* triangleChannel_;
-    NoiseChannel* noiseChannel_;
+    // Everything done while running is called on the channels directly. channels_ is only for resetting and serializing
+    // the ones that share AudioChannel.
+    PulseChannel pulseChannel1_;
+    PulseChannel pulseChannel2_;
+    TriangleChannel triangleChannel_;
+    NoiseChannel noiseChannel_;
+    DmcChannel dmcChannel_;
 
-    std::unique_ptr<DmcChannel> dmcChannel_;
+    std::array<AudioChannel*, 4> channels_;
 
     void HalfFrameClock();
     void QuarterFrameClock();
 
-// Lookup tables
+// Catch-up
+private:
+    // Clock() and Run() only count cycles. The APU is caught up to them all at once whenever something outside of it
+    // could tell the difference: register accesses, DMC fetches, reading samples, and the cycles on which the frame
+    // counter steps or the DMC sample buffer empties, since those change what IRQ() and DmcRequestSample() return.
+    // Catching up jumps from one timer expiry that can change the output to the next, and silent channels are
+    // advanced without clocking them one cycle at a time.
+    size_t pendingCycles_;
+    size_t syncDeadline_;   // Pending cycles that force a catch-up
+
+    void Sync();
+    void UpdateSyncDeadline();
+    void Tick();
+    void RunChannels(size_t cycles);
+    void ClockChannels();
+    size_t CyclesUntilApuCycle(int apuCycles) const;
+    size_t CyclesUntilOutputChange() const;
+
+// Mixer
+private:
+    int amplitude_;
+
+    // Output levels of the pulse and triangle/noise/DMC mixers, scaled so both at full volume add up to 0xFFFF
+    std::array<int, 31> pulseLevels_;
+    std::array<int, 203> tndLevels_;
+
+    void UpdateAmplitude();
+
+// Audio output
 private:
-    std::array<float, 31> pulseTable_;
-    std::array<float, 203> tndTable_;
+    // Every change in the mixer's output goes in the blip buffer as a step, timed in CPU cycles since the current block
+    // of samples started. Blocks end whenever samples are asked for, and at least every AUDIO_BLOCK_CYCLES so the steps
+    // never get too far ahead of the samples made from them. The blip buffer always makes INTERNAL_SAMPLE_RATE samples
+    // per second, well above anything audible, and the resampler converts them to whatever rate was asked for.
+    static constexpr uint32_t AUDIO_BLOCK_CYCLES = 4096;
+    static constexpr double INTERNAL_SAMPLE_RATE = 96000;
+
+    BlipBuffer blipBuffer_;
+    Resampler resampler_;
+    uint32_t audioCycle_;
+
+    void AdvanceAudio(size_t cycles);
+    void EndAudioBlock();
 };
 
 #endif
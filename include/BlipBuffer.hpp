@@ -0,0 +1,67 @@
+#ifndef BLIPBUFFER_HPP
+#define BLIPBUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Band-limited step synthesis. Changes in a signal are added as steps at the clock they happen on, and each step is
+// spread over the neighbouring output samples with a windowed sinc kernel instead of landing on whichever sample is
+// nearest. Time is counted in clocks from the start of the current frame, and ending a frame makes every sample before
+// its end available to read.
+class BlipBuffer
+{
+public:
+    BlipBuffer();
+    ~BlipBuffer() = default;
+
+    // Can be changed between frames without losing samples already made
+    void SetRates(double clockRate, double sampleRate);
+    void Clear();
+
+    void AddDelta(uint32_t time, int delta);
+    void EndFrame(uint32_t time);
+
+    // Only call these between ending one frame and adding anything to the next
+    size_t SamplesAvailable() const;
+    uint32_t ClocksUntilSamples(size_t count) const;    // Clocks the next frame must run for before count are available
+    size_t ReadSamples(int16_t* buffer, size_t count);
+
+private:
+    void Integrate(int16_t* buffer, size_t count);
+
+// Timing
+private:
+    // Positions are in samples, fixed point with TIME_BITS of fraction. The top PHASE_BITS of the fraction pick which
+    // kernel a step uses.
+    static constexpr int TIME_BITS = 32;
+    static constexpr int PHASE_BITS = 6;
+    static constexpr size_t PHASE_COUNT = 1 << PHASE_BITS;
+
+    uint64_t factor_;   // Samples per clock
+    uint64_t offset_;   // Position the current frame started at, past the last available sample
+
+// Kernels
+private:
+    // A step's kernel is the band-limited impulse at its phase, which becomes the step once the buffer is summed up on
+    // the way out. Each kernel sums to exactly 1 << KERNEL_BITS so steps never leave an offset behind.
+    static constexpr size_t KERNEL_WIDTH = 16;
+    static constexpr int KERNEL_BITS = 15;
+    static constexpr double CUTOFF = 0.45;  // Fraction of the sample rate passed
+
+    std::array<std::array<int32_t, KERNEL_WIDTH>, PHASE_COUNT> kernels_;
+
+// Samples
+private:
+    // The integrator leaks 1 / (1 << BASS_SHIFT) of itself each sample, a DC blocking filter around 15Hz at 96kHz
+    static constexpr int BASS_SHIFT = 10;
+    static constexpr double CAPACITY_SECONDS = 0.25;
+
+    std::vector<int64_t> buffer_;   // Kernel sums for each sample, capacity_ plus room for a frame and its last kernel
+    size_t capacity_;
+    size_t available_;
+    int64_t integrator_;
+};
+
+#endif
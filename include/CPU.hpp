@@ -4,7 +4,6 @@
 #include "OpCodes.hpp"
 #include <array>
 #include <cstdint>
-#include <functional>
 #include <fstream>
 
 constexpr uint8_t CARRY_FLAG = 0x01;
@@ -27,9 +26,14 @@ constexpr uint16_t RESET_VECTOR_HI = 0xFFFD;
 constexpr uint16_t BRK_VECTOR_LO = 0xFFFE;
 constexpr uint16_t BRK_VECTOR_HI = 0xFFFF;
 
+// Accesses that require the PPU and APU to be caught up when stepping whole instructions
+constexpr uint16_t IO_REGISTERS_START = 0x2000;
+constexpr uint16_t IO_REGISTERS_END = 0x4020;
+
 class APU;
 class Cartridge;
 class Controller;
+class CpuTrace;
 class PPU;
 
 class CPU
@@ -41,6 +45,13 @@ public:
     void Reset();
     void LoadCartridge(Cartridge* cartridge);
 
+// Instruction stepping
+public:
+    bool CanStepInstruction(size_t cycles);
+    size_t StepInstruction();
+    void CatchUp();
+    void UpdateEventHorizon();
+
 public:
     bool Serializable();
     void Serialize(std::ofstream& saveState);
@@ -82,10 +93,52 @@ private:
     size_t cycle_;
     bool oddCycle_;
 
-// Logging
+// Tracing
+public:
+    void SetTrace(CpuTrace* trace);
+
+private:
+    CpuTrace* trace_;
+
+    void TraceInstruction();
+    uint8_t Peek(uint16_t addr);
+
+// Timing
 private:
-    std::ofstream log_;
     uint64_t totalCycles_;
+    uint64_t syncedCycles_;     // Cycles the PPU and APU have been clocked for
+    uint64_t eventCycle_;       // First cycle that may see a DMC request, interrupt, vblank, or completed frame
+    uint64_t stepEndCycle_;     // Last cycle the instruction being stepped can take
+    uint8_t const* operandPage_;    // PRG ROM page holding the operands of the instruction being stepped, if any
+
+    void Tick();
+
+// Idle loop skipping
+public:
+    size_t SkipIdleLoop(size_t cycles);
+    void SetIdleLoopSkipping(bool enabled);
+
+private:
+    bool idleLoopSkipping_;
+    bool idleLoopClean_;            // No writes or register accesses other than PPUSTATUS reads since idleLoopHead_
+    bool idleLoopReadsStatus_;
+    uint16_t idleLoopHead_;         // Target of the last backward branch or jump
+    uint64_t idleLoopHeadCycle_;
+    uint64_t idleLoopStatusLimit_;  // First cycle PPUSTATUS could change after the loop first read it
+    size_t idleLoopLength_;         // Cycles per iteration once an iteration has been found to change nothing
+
+    struct
+    {
+        uint8_t accumulator;
+        uint8_t status;
+        uint8_t stackPointer;
+        uint8_t x;
+        uint8_t y;
+    } idleLoopRegisters_;
+
+    void TrackIdleLoop(uint16_t instructionAddr);
+    void WatchIdleLoop(uint16_t head);
+    bool IdleLoopRegistersUnchanged() const;
 
 // APU DMC
 private:
@@ -98,7 +151,7 @@ private:
     struct
     {
         uint8_t accumulator;        // A
-        uint8_t status;             // P
+        uint8_t status;             // P, only I and D are current here. Use GetStatus() for the full byte.
         uint8_t stackPointer;       // S
         uint8_t x;                  // X
         uint8_t y;                  // Y
@@ -107,23 +160,30 @@ private:
 
     std::array<uint8_t, 0x0800> RAM_;
 
-    bool IsCarry() const;
-    void SetCarry(bool val);
-
-    bool IsZero() const;
-    void SetZero(bool val);
-
     bool IsInterruptDisable() const;
     void SetInterruptDisable(bool val);
 
     bool IsDecimal() const;
     void SetDecimal(bool val);
 
-    bool IsOverflow() const;
-    void SetOverflow(bool val);
+// Lazy flags
+private:
+    // N, Z, and V are kept as the values they were derived from and only packed into P when it's pushed, tested by a
+    // branch, traced, or saved.
+    uint8_t negativeResult_;    // N is bit 7
+    uint8_t zeroResult_;        // Z is set when this is 0
+    uint8_t overflowResult_;    // V is bit 7
+    bool carry_;
+
+    uint8_t GetStatus() const;
+    void SetStatus(uint8_t status);
+
+    void SetNegativeZero(uint8_t result) { negativeResult_ = result; zeroResult_ = result; }
+
+    bool IsCarry() const { return carry_; }
+    void SetCarry(bool val) { carry_ = val; }
 
-    bool IsNegative() const;
-    void SetNegative(bool val);
+    void SetOverflow(bool val) { overflowResult_ = val ? MSB : 0x00; }
 
 // OAM DMA
 private:
@@ -144,8 +204,37 @@ private:
     uint8_t regData_;
     bool isStoreOp_;
     bool branchCondition_;
-    std::function<void()> instruction_;
-    std::function<void()> tickFunction_;
+    void (CPU::*instruction_)();
+    void (CPU::*tickFunction_)();
+
+// Instruction Table
+private:
+    enum class Register : uint8_t
+    {
+        NONE,
+        A,
+        X,
+        Y
+    };
+
+    struct InstructionEntry
+    {
+        void (CPU::*tickFunction)() = nullptr;  // Addressing mode, or the full instruction for special cases like JSR
+        void (CPU::*instruction)() = nullptr;   // Operation performed on the final cycle of the addressing mode
+        Register index = Register::NONE;        // Index register for indexed addressing modes
+        Register regData = Register::NONE;      // Source register for stores and compares
+        bool isStoreOp = false;
+        uint8_t branchFlag = 0x00;              // Status flag tested by branch instructions
+        bool branchIfSet = false;
+        void (CPU::*stepFunction)() = nullptr;  // Whole-instruction equivalent of tickFunction
+        uint8_t maxCycles = 0;                  // Most cycles the instruction can take, excluding DMA and DMC stalls
+    };
+
+    static constexpr std::array<InstructionEntry, 256> CreateInstructionTable();
+    static const std::array<InstructionEntry, 256> INSTRUCTION_TABLE;
+
+    uint8_t GetRegister(Register reg) const;
+    void LoadInstruction(InstructionEntry const& entry);
 
 // Addressing Modes
 private:
@@ -172,6 +261,10 @@ private:
     void ASL();
     void BIT();
     void BRK();
+    void CLC();
+    void CLD();
+    void CLI();
+    void CLV();
     void CMP();
     void DEC();
     void DEX();
@@ -185,6 +278,7 @@ private:
     void LDX();
     void LDY();
     void LSR();
+    void NOP();
     void ORA();
     void PHA();
     void PHP();
@@ -195,6 +289,9 @@ private:
     void RTI();
     void RTS();
     void SBC();
+    void SEC();
+    void SED();
+    void SEI();
     void TAX();
     void TAY();
     void TSX();
@@ -205,6 +302,42 @@ private:
     void IndirectJMP();
 
     void DecodeOpCode();
+
+// Instruction stepping
+private:
+    uint8_t SyncedRead(uint16_t addr);
+    void SyncedWrite(uint16_t addr, uint8_t data);
+    uint8_t SyncedReadAndIncrementPC();
+    void SetOperandPage();
+    void SyncedNextOpCode();
+    bool DeferToClock(size_t cycle);
+
+    void StepImmediate();
+    void StepAbsolute();
+    void StepZeroPage();
+    void StepImplied();
+    void StepAbsoluteIndexed();
+    void StepZeroPageIndexed();
+    void StepIndirectX();
+    void StepIndirectY();
+    void StepRelative();
+
+    void StepAccumulator();
+    void StepZeroPageRMW();
+    void StepZeroPageIndexedRMW();
+    void StepAbsoluteRWM();
+    void StepAbsoluteIndexedRMW();
+
+    void StepBRK();
+    void StepJSR();
+    void StepPHA();
+    void StepPHP();
+    void StepPLA();
+    void StepPLP();
+    void StepRTI();
+    void StepRTS();
+    void StepAbsoluteJMP();
+    void StepIndirectJMP();
 };
 
 #endif
@@ -1,8 +1,12 @@
 #ifndef CARTRIDGE_HPP
 #define CARTRIDGE_HPP
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <functional>
+#include <utility>
 
 // iNES Header Flags
 
@@ -27,6 +31,13 @@ constexpr uint8_t TV_SYSTEM_UNOFFICIAL = 0x03;
 constexpr uint8_t PRG_RAM_PRESENT = 0x10;
 constexpr uint8_t BUS_CONFLICT = 0x20;
 
+// CPU address space is split into 8KB pages for direct PRG access
+constexpr size_t PRG_PAGE_SIZE = 0x2000;
+constexpr size_t PRG_PAGE_SHIFT = 13;
+constexpr size_t PRG_PAGE_COUNT = 8;
+constexpr size_t PRG_RAM_PAGE = 0x6000 >> PRG_PAGE_SHIFT;
+constexpr size_t PRG_ROM_PAGE = 0x8000 >> PRG_PAGE_SHIFT;
+
 enum class MirrorType : uint8_t {HORIZONTAL, VERTICAL, SINGLE_LOW, SINGLE_HIGH, QUAD};
 
 class Cartridge
@@ -39,12 +50,32 @@ public:
     virtual uint8_t ReadPRG(uint16_t addr) = 0;
     virtual void WritePRG(uint16_t addr, uint8_t data) = 0;
 
+    // Memory backing the 8KB page containing addr, or nullptr if accesses to it must go through ReadPRG/WritePRG
+    uint8_t const* GetPrgReadPage(uint16_t addr) const { return prgReadPages_[addr >> PRG_PAGE_SHIFT]; }
+    uint8_t* GetPrgWritePage(uint16_t addr) const { return prgWritePages_[addr >> PRG_PAGE_SHIFT]; }
+
     virtual uint8_t ReadCHR(uint16_t addr) = 0;
     virtual void WriteCHR(uint16_t addr, uint8_t data) = 0;
 
     MirrorType GetMirrorType() { return mirrorType_; };
+
+    // Called with the new mirroring whenever a mapper changes it, and once with the current mirroring when set
+    void SetMirroringCallback(std::function<void(MirrorType)> callback)
+    {
+        mirroringChanged_ = std::move(callback);
+
+        if (mirroringChanged_)
+        {
+            mirroringChanged_(mirrorType_);
+        }
+    }
+
+    // Called whenever a CPU write changes which CHR banks are mapped, or which banks a mapper will switch to on its own
+    void SetChrBanksCallback(std::function<void()> callback) { chrBanksChanged_ = std::move(callback); }
+
     virtual void SaveRAM() = 0;
     virtual bool IRQ() = 0;
+    virtual size_t ChrReadsUntilIrq() { return SIZE_MAX; }  // Fewest PPU CHR reads before the cartridge can assert IRQ
 
     virtual void Serialize(std::ofstream& saveState) = 0;
     virtual void Deserialize(std::ifstream& saveState) = 0;
@@ -52,7 +83,34 @@ public:
 protected:
     MirrorType mirrorType_;
     bool chrRamMode_;
+
+    void SetMirrorType(MirrorType mirrorType)
+    {
+        mirrorType_ = mirrorType;
+
+        if (mirroringChanged_)
+        {
+            mirroringChanged_(mirrorType_);
+        }
+    }
+
+    void ChrBanksChanged()
+    {
+        if (chrBanksChanged_)
+        {
+            chrBanksChanged_();
+        }
+    }
+
+    // Updated by mappers whenever a bank switch changes what a page maps to
+    std::array<uint8_t const*, PRG_PAGE_COUNT> prgReadPages_ {};
+    std::array<uint8_t*, PRG_PAGE_COUNT> prgWritePages_ {};
+
     virtual void LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks) = 0;
+
+private:
+    std::function<void(MirrorType)> mirroringChanged_;
+    std::function<void()> chrBanksChanged_;
 };
 
 #endif
@@ -0,0 +1,82 @@
+#ifndef CPUTRACE_HPP
+#define CPUTRACE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+// Trace file layout: TRACE_MAGIC followed by TraceRecords until the end of the file
+constexpr std::array<char, 8> TRACE_MAGIC = {'N', 'E', 'S', 'T', 'R', 'C', '0', '1'};
+
+// Ring buffer
+constexpr size_t TRACE_RING_SIZE = 0x10000;  // Records, must be a power of two
+constexpr size_t TRACE_RING_MASK = TRACE_RING_SIZE - 1;
+
+struct TraceRecord
+{
+    uint64_t cycle;             // CPU cycle the opcode was fetched on
+    uint16_t programCounter;    // Address of the opcode
+    uint16_t scanline;
+    uint16_t dot;
+    uint8_t opCode;
+    uint8_t accumulator;
+    uint8_t x;
+    uint8_t y;
+    uint8_t status;
+    uint8_t stackPointer;
+    std::array<uint8_t, 2> operands;    // Bytes following the opcode, 0 if they could only be read with side effects
+};
+
+static_assert(sizeof(TraceRecord) == 24, "TraceRecord layout is part of the trace file format");
+
+class CpuTrace
+{
+public:
+    CpuTrace(std::filesystem::path tracePath);
+    ~CpuTrace();
+
+    bool IsOpen() const { return traceFile_.is_open(); }
+
+    // Called from the emulation thread. Waits for the writer thread if the ring is full so no records are lost.
+    void Record(TraceRecord const& record)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+
+        while ((head - cachedTail_) == TRACE_RING_SIZE)
+        {
+            cachedTail_ = tail_.load(std::memory_order_acquire);
+
+            if ((head - cachedTail_) == TRACE_RING_SIZE)
+            {
+                std::this_thread::yield();
+            }
+        }
+
+        ring_[head & TRACE_RING_MASK] = record;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+private:
+    void WriterThread();
+    size_t Drain();
+
+// Ring buffer
+private:
+    std::unique_ptr<TraceRecord[]> ring_;
+
+    alignas(64) std::atomic<size_t> head_;  // Next record to be written by the emulation thread
+    size_t cachedTail_;                     // Emulation thread's copy of tail_
+    alignas(64) std::atomic<size_t> tail_;  // Next record to be written to disk
+
+// Writer thread
+private:
+    std::ofstream traceFile_;
+    std::atomic<bool> running_;
+    std::thread writerThread_;
+};
+
+#endif
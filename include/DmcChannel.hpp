@@ -12,16 +12,19 @@ public:
     DmcChannel();
     void Reset();
 
-    uint8_t GetOutput();
-    int GetBytesRemaining() { return bytesRemaining_; }
+    uint8_t GetOutput() const;
+    int GetBytesRemaining() const { return bytesRemaining_; }
     void SetEnabled(bool enabled);
 
     void Clock();
+    void Run(int clocks);
+    int ClocksUntilOutputChange() const;
 
     void RegisterUpdate(uint16_t addr, uint8_t data);
 
-    bool IRQ() { return irq_; }
+    bool IRQ() const { return irq_; }
     std::optional<uint16_t> RequestSample();
+    int CyclesUntilRequest();
     void SetSample(uint8_t sample);
 
     void Serialize(std::ofstream& saveState);
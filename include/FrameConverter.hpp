@@ -0,0 +1,64 @@
+#ifndef FRAMECONVERTER_HPP
+#define FRAMECONVERTER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+
+// Frames are 256x240 pixels. The PPU writes each pixel as a palette index: bits 0-5 are the palette RAM entry, bits 6-8
+// are the PPUMASK color emphasis bits, and bit 9 is set in grayscale mode.
+constexpr size_t FRAME_WIDTH = 256;
+constexpr size_t FRAME_HEIGHT = 240;
+constexpr size_t FRAME_BUFFER_SIZE = FRAME_WIDTH * FRAME_HEIGHT;
+
+constexpr uint16_t PIXEL_COLOR_MASK = 0x003F;
+constexpr int PIXEL_EMPHASIS_SHIFT = 6;
+constexpr uint16_t PIXEL_GRAYSCALE = 0x0200;
+constexpr size_t PIXEL_LUT_SIZE = 0x0400;
+
+// Rows hidden by overscan
+constexpr size_t OVERSCAN_TOP = 8;
+constexpr size_t OVERSCAN_BOTTOM = 232;
+
+// Output formats, named by byte order in memory
+enum class PixelFormat
+{
+    RGB24,
+    RGBA8888,
+    BGRA8888
+};
+
+constexpr size_t BytesPerPixel(PixelFormat format)
+{
+    return (format == PixelFormat::RGB24) ? 3 : 4;
+}
+
+class FrameConverter
+{
+public:
+    FrameConverter(std::ifstream& normalColors, std::ifstream& grayscaleColors);
+    ~FrameConverter() = default;
+
+    void SetOverscan(bool enabled);
+
+    // Convert a palette indexed frame. pitch is the number of bytes between the starts of two rows in pixels.
+    void Convert(uint16_t const* frame, uint8_t* pixels, size_t pitch, PixelFormat format) const;
+
+private:
+    void ConvertRow(uint16_t const* src, uint8_t* dst, PixelFormat format) const;
+    void ClearRow(uint8_t* dst, PixelFormat format) const;
+
+// Lookup tables
+private:
+    // Every possible pixel, packed in the byte order of the output format. RGB24 reads the first three bytes of rgbaLut_.
+    alignas(64) std::array<uint32_t, PIXEL_LUT_SIZE> rgbaLut_;
+    alignas(64) std::array<uint32_t, PIXEL_LUT_SIZE> bgraLut_;
+    uint32_t opaqueBlack_;
+
+    bool useAvx2_;
+    std::atomic<bool> overscan_;
+};
+
+#endif
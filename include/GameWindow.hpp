@@ -1,8 +1,12 @@
 #ifndef GAMEWINDOW_HPP
 #define GAMEWINDOW_HPP
 
+#include "SampleRing.hpp"
+#include "Scaler.hpp"
 #include <array>
+#include <atomic>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <tuple>
@@ -21,11 +25,15 @@ constexpr int WINDOW_SCALE = 4;
 constexpr float ASPECT_RATIO = (float)SCREEN_WIDTH / (float)SCREEN_HEIGHT;
 
 // Audio
-constexpr int AUDIO_SAMPLE_RATE = 44100;
-constexpr double TIME_PER_AUDIO_SAMPLE = 1.0 / AUDIO_SAMPLE_RATE;
+constexpr std::array<int, 3> AUDIO_SAMPLE_RATES = {44100, 48000, 96000};   // Asked of the audio device
+constexpr size_t DEFAULT_SAMPLE_RATE_OPTION = 1;   // Index into AUDIO_SAMPLE_RATES
 constexpr int CPU_CLOCK_SPEED = 1789773;
 constexpr double TIME_PER_NES_CLOCK = 1.0 / CPU_CLOCK_SPEED;
 constexpr int AUDIO_SAMPLE_BUFFER_COUNT = 256;
+constexpr int AUDIO_RING_SIZE = 4096;
+constexpr int AUDIO_TARGET_FILL = 4 * AUDIO_SAMPLE_BUFFER_COUNT;  // Samples kept queued up ahead of the audio device
+constexpr double MAX_RATE_ADJUSTMENT = 0.005;   // Largest fraction the sample rate is nudged by to hold the target fill
+constexpr double MAX_EMULATION_LAG = 0.05;      // Seconds the NES can fall behind before it stops trying to catch up
 
 // GUI
 constexpr int BUTTONS_COUNT = 7;
@@ -35,7 +43,7 @@ class NES;
 class GameWindow
 {
 public:
-    GameWindow(NES& nes, uint8_t* frameBuffer, std::filesystem::path romPath = "");
+    GameWindow(NES& nes, std::filesystem::path romPath = "");
     ~GameWindow() = default;
 
     void Run();
@@ -43,7 +51,6 @@ public:
 // NES
 private:
     NES& nes_;
-    uint8_t* frameBuffer_;
     std::string romHash_;
     std::string fileName_;
 
@@ -66,18 +73,61 @@ private:
     SDL_Window* window_;
     SDL_Renderer* renderer_;
     SDL_AudioDeviceID audioDevice_;
-    SDL_Thread* renderThread_;
+    std::atomic<int> audioSampleRate_;  // Rate the device actually runs at, which the APU is asked for directly
 
 // SDL helpers
 private:
     void InitializeSDL();
     void HandleSDLInputs(SDL_Scancode key);
     void UpdateTitle();
-    void LockAudio();
-    void UnlockAudio();
-    static int UpdateScreen(void* data);
+    void OpenAudioDevice(int sampleRate);
     static void GetAudioSamples(void* userdata, Uint8* stream, int len);
 
+// Emulation thread
+private:
+    // The NES runs on its own thread, paced by the system clock, and queues its samples in sampleRing_ for the audio
+    // callback to drain. The sample rate it asks the APU for is nudged up or down slightly to keep the ring near
+    // AUDIO_TARGET_FILL, which makes up for the system clock and the audio device's clock drifting apart.
+    SDL_Thread* emulationThread_;
+    SDL_mutex* emulationMutex_;     // Held while running the NES, or by the main thread to keep it from running
+    std::atomic<bool> emulationRunning_;
+    SampleRing sampleRing_;
+
+    void StartEmulation();
+    void StopEmulation();
+    void LockEmulation();
+    void UnlockEmulation();
+    void RunEmulation();
+    static int EmulationThread(void* data);
+
+// Presenter thread
+private:
+    SDL_Thread* presenterThread_;
+    SDL_sem* frameReadySemaphore_;  // Posted by the emulation thread when the NES completes a frame
+    SDL_mutex* presenterMutex_;     // Held while presenting a frame, or by the main thread to use the renderer
+    SDL_Texture* frameTexture_;     // Streaming texture the frame buffer is converted into
+    std::atomic<bool> presenterRunning_;
+
+    std::atomic<ScalerType> scalerType_;        // Set from the options menu
+    std::atomic<bool> ntscOutput_;              // Set from the options menu, takes the place of scaling
+    int textureWidth_;
+    int textureHeight_;
+    std::unique_ptr<Scaler> scaler_;
+    std::unique_ptr<uint32_t[]> scalerInput_;   // Converted frame for the scaler to read from
+
+    // Frames the NES reused or skipped come back from GetFrameBuffer() as the one already on screen, which is left alone
+    // unless something else drew over the window or the output settings changed.
+    uint16_t const* presentedFrame_;
+    ScalerType presentedScaler_;
+    std::atomic<bool> refreshScreen_;
+
+    void StartPresenter();
+    void CreateFrameTexture(int width, int height);
+    void StopPresenter();
+    void SignalFrameReady();
+    void UpdateScreen();
+    static int PresenterThread(void* data);
+
 // Main loop
 private:
     bool exit_;
@@ -119,8 +169,15 @@ private:
     RightMenuOption rightMenuOption_;
 
     bool overscan_;
+    bool instructionStepping_;
+    bool idleLoopSkipping_;
+    int frameSkip_;     // Off, auto, then a fixed number of frames
+    int scalerOption_;
+    bool ntscFilter_;
+    bool cpuTrace_;
     bool mute_;
     int audioVolume_;
+    int sampleRateOption_;
 
     enum WindowScale { TWO = 2, THREE, FOUR, FIVE };
     WindowScale windowScale_;
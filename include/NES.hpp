@@ -1,6 +1,11 @@
 #ifndef NES_HPP
 #define NES_HPP
 
+#include "FrameConverter.hpp"
+#include "NtscFilter.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
@@ -11,12 +16,20 @@ class APU;
 class Cartridge;
 class CPU;
 class Controller;
+class CpuTrace;
 class PPU;
 
+enum class FrameSkipMode
+{
+    OFF,
+    FIXED,      // Skip a set number of frames after each one drawn
+    ADAPTIVE    // Skip while the presenter hasn't picked up the last frame drawn
+};
+
 class NES
 {
 public:
-    NES(uint8_t* frameBuffer, std::ifstream& normalColors, std::ifstream& grayscaleColors);
+    NES(std::ifstream& normalColors, std::ifstream& grayscaleColors);
     ~NES();
 
     void SetControllerInputs(uint8_t controller1, uint8_t controller2);
@@ -25,28 +38,101 @@ public:
     bool Ready();
 
     bool FrameReady();
-    int16_t GetAudioSample();
+
+    void SetAudioRates(double clockRate, double sampleRate);
+    size_t CyclesUntilAudioSamples(size_t count);
+    size_t ReadAudioSamples(int16_t* buffer, size_t count);
 
     bool LoadCartridge(std::filesystem::path romPath, std::filesystem::path savePath);
     void UnloadCartridge();
 
     void Clock();
+    size_t Run(size_t cycles);
     void RunUntilFrameReady();
     void RunUntilSerializable();
 
     void SetOverscan(bool enabled);
+    void SetInstructionStepping(bool enabled);
+    void SetIdleLoopSkipping(bool enabled);
+
+    bool StartTrace(std::filesystem::path tracePath);
+    void StopTrace();
 
     void Serialize(std::ofstream& saveState);
     void Deserialize(std::ifstream& saveState);
 
+// Frame buffers
+public:
+    uint16_t const* GetFrameBuffer();
+    uint16_t const* GetLastFrame() const;
+    void ConvertFrame(uint16_t const* frame, uint8_t* pixels, size_t pitch, PixelFormat format) const;
+    uint8_t GetFramePhase() const;
+    void FilterFrame(uint16_t const* frame, uint8_t phase, uint8_t* pixels, size_t pitch) const;
+
+    void SetFrameSkip(FrameSkipMode mode, int frames = 0);
+    uint64_t GetReusedFrameCount() const;
+
+private:
+    // The PPU draws into the back buffer. Each completed frame is swapped into the ready slot, and the presenter swaps
+    // the ready slot with its front buffer when it holds a frame it hasn't seen yet.
+    static constexpr uint8_t FRAME_INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH_FRAME = 0x04;
+
+    std::array<std::unique_ptr<uint16_t[]>, 3> frameBuffers_;
+    std::array<uint8_t, 3> framePhases_;    // Color subcarrier phase each frame started on
+    std::atomic<uint8_t> readyFrame_;   // Index of the newest complete frame, with FRESH_FRAME set if not presented yet
+    uint8_t backFrame_;
+    uint8_t frontFrame_;
+    uint8_t lastFrame_;
+    FrameConverter frameConverter_;
+    NtscFilter ntscFilter_;
+
+    void SwapFrameBuffers();
+
+// Frame skipping
+private:
+    // Most frames adaptive skipping will skip in a row, so the screen keeps updating however far behind it gets
+    static constexpr int MAX_ADAPTIVE_SKIP = 4;
+
+    std::atomic<FrameSkipMode> frameSkipMode_;
+    std::atomic<int> frameSkipCount_;
+    int framesSkipped_;     // Consecutive frames skipped, including the one in progress
+    bool frameSkipped_;     // The frame in progress isn't being drawn
+
+    void FrameCompleted();
+    bool SkipNextFrame();
+
+// Frame reuse
+private:
+    // Frames where nothing has changed for this many frames in a row are reused. Besides the frame itself, that covers the
+    // frame before it, since state like MMC2's CHR latches carries over from one frame into the next.
+    static constexpr int REUSE_AFTER_UNCHANGED = 2;
+
+    int framesUnchanged_;           // Consecutive frames in which nothing that affects pixels changed
+    uint64_t reusedFrames_;         // Since the cartridge was loaded
+
+// Profiling
+public:
+    struct ComponentTimes
+    {
+        std::chrono::nanoseconds cpu {0};
+        std::chrono::nanoseconds ppu {0};
+        std::chrono::nanoseconds apu {0};
+    };
+
+    size_t RunProfiled(size_t cycles, ComponentTimes& times);
+
 private:
     std::unique_ptr<APU> apu_;
     std::unique_ptr<Cartridge> cartridge_;
     std::unique_ptr<Controller> controller_;
     std::unique_ptr<PPU> ppu_;
     std::unique_ptr<CPU> cpu_;
+    std::unique_ptr<CpuTrace> trace_;
 
     bool cartLoaded_;
+    bool instructionStepping_;
+    bool frameReady_;
 
     void InitializeCartridge(std::filesystem::path romPath, std::filesystem::path savePath);
 };
@@ -6,20 +6,22 @@
 #include <cstdint>
 #include <fstream>
 
-class NoiseChannel : public virtual AudioChannel
+class NoiseChannel final : public AudioChannel
 {
 public:
     NoiseChannel();
     void Reset() override;
 
-    uint8_t GetOutput() override;
-    void SetEnabled(bool enabled) override;
+    uint8_t GetOutput() const;
+    void SetEnabled(bool enabled);
 
-    void Clock() override;
-    void HalfFrameClock() override;
-    void QuarterFrameClock() override;
+    void Clock();
+    void Run(int clocks);
+    int ClocksUntilOutputChange() const;
+    void HalfFrameClock();
+    void QuarterFrameClock();
 
-    void RegisterUpdate(uint16_t addr, uint8_t data) override;
+    void RegisterUpdate(uint16_t addr, uint8_t data);
 
     void Serialize(std::ofstream& saveState) override;
     void Deserialize(std::ifstream& saveState) override;
@@ -27,11 +29,18 @@ public:
 private:
     static constexpr int NOISE_TIMER_LOOKUP_TABLE[16] = {4, 8, 16, 32, 64, 96, 128, 160, 202, 254, 380, 508, 762, 1016, 2034, 4068};
 
+// Timer
+private:
+    int timerReload_;
+    int timer_;
+
 // Control
 private:
     bool mode_;
     uint16_t shiftRegister_;
 
+    void ClockShiftRegister();
+
 // Envelope
 private:
     // Constant volume
@@ -44,11 +53,6 @@ private:
     uint8_t envelopeTimerReload_;
     int envelopeTimer_;
     uint8_t decayLevel_;
-
-// Timer
-private:
-    int timerReload_;
-    int timer_;
 };
 
 #endif
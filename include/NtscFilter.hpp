@@ -0,0 +1,59 @@
+#ifndef NTSCFILTER_HPP
+#define NTSCFILTER_HPP
+
+#include "FrameConverter.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Composite video output. Each pixel is turned into the 8 samples of signal the PPU generates for it, and the signal is
+// decoded back to RGB twice per pixel, so frames come out NTSC_FRAME_WIDTH x FRAME_HEIGHT.
+constexpr size_t NTSC_FRAME_WIDTH = FRAME_WIDTH * 2;
+
+class NtscFilter
+{
+public:
+    NtscFilter();
+    ~NtscFilter() = default;
+
+    void SetOverscan(bool enabled);
+
+    // Filter a palette indexed frame into BGRA8888 pixels. phase is the color subcarrier phase the frame started on,
+    // see NES::GetFramePhase(). pitch is the number of bytes between the starts of two rows in pixels.
+    void Filter(uint16_t const* frame, uint8_t phase, uint8_t* pixels, size_t pitch) const;
+
+private:
+    void FilterRow(uint16_t const* src, uint8_t* dst, size_t phase) const;
+    void ClearRow(uint8_t* dst) const;
+
+// Signal
+private:
+    static constexpr int SAMPLES_PER_PIXEL = 8;
+    static constexpr int SUBCARRIER_PERIOD = 12;    // Samples per color subcarrier cycle
+    static constexpr size_t PHASE_COUNT = 3;        // Pixels start 0, 4, or 8 samples into a subcarrier cycle
+    static constexpr size_t COLOR_COUNT = 0x0200;   // Palette entry and emphasis bits of a pixel
+
+    static double Signal(uint16_t color, int phase);
+
+// Kernels
+private:
+    // Output pixels are B, G, R, A in 16 bit fixed point, two to a kernel half. The signal a pixel generates is decoded
+    // into both of its own output pixels and the closest output pixel on either side, since the decoder looks at a full
+    // subcarrier cycle of samples.
+    static constexpr int FRACTION_BITS = 4;
+
+    struct Kernel
+    {
+        alignas(16) std::array<int16_t, 8> center;  // Both of this pixel's output pixels
+        alignas(16) std::array<int16_t, 8> side;    // Right output pixel of the pixel to the left, then left output
+                                                    // pixel of the pixel to the right
+    };
+
+    std::array<std::array<Kernel, COLOR_COUNT>, PHASE_COUNT> kernels_;
+    std::atomic<bool> overscan_;
+
+    Kernel const& GetKernel(size_t phase, uint16_t pixel) const;
+};
+
+#endif
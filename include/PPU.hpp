@@ -6,6 +6,8 @@
 #include <fstream>
 #include <utility>
 
+enum class MirrorType : uint8_t;
+
 // PPUCTRL $2000
 
 constexpr uint8_t BASE_NT_ADDRESS_MASK = 0x03;
@@ -52,21 +54,29 @@ class MMC3;
 class PPU
 {
 public:
-    PPU(uint8_t* frameBuffer, std::ifstream& normalColors, std::ifstream& grayscaleColors);
+    PPU();
     ~PPU() = default;
     void Reset();
 
     void Clock();
+    void Run(size_t cycles);
     bool FrameReady();
+    uint8_t FramePhase() const;
 
     uint8_t ReadReg(uint16_t addr);
     void WriteReg(uint16_t addr, uint8_t data);
 
     bool NMI();
     std::pair<uint16_t, uint16_t> GetState();
+    size_t CyclesUntilEvent();
+    size_t CyclesUntilStatusChange();
 
     void LoadCartridge(Cartridge* cartridge);
-    void SetOverscan(bool enabled);
+    void SetFrameBuffer(uint16_t* frameBuffer);
+    void SetFrameSkipped(bool skipped);
+    void SetReusedFrame(uint16_t const* frame);
+    bool FrameReused() const;
+    bool FrameChanged();
 
 public:
     bool Serializable();
@@ -75,13 +85,13 @@ public:
 
 private:
     void Initialize();
-    void InitializePalettes(std::ifstream& normalColors, std::ifstream& grayscaleColors);
 
 private:
     uint8_t Read(uint16_t addr);
     void Write(uint16_t addr, uint8_t data);
 
     bool RenderingEnabled();
+    bool VramAddressInUse();
     void SetNMI();
     void RunAhead();
 
@@ -94,22 +104,56 @@ private:
 
 // Palettes
 private:
-    struct RGB
-    {
-        uint8_t R;
-        uint8_t G;
-        uint8_t B;
-    };
+    uint16_t pixelAttributes_;  // Emphasis and grayscale bits of PPUMASK in frame buffer pixel format
 
-    std::array<std::array<RGB, 0x40>, 8> NormalColors_;
-    std::array<std::array<RGB, 0x40>, 8> GrayscaleColors_;
-    size_t paletteIndex_;
-    bool useGrayscale_;
+    void SetPixelAttributes();
 
 // Scanlines
 private:
-    void PreRenderLine();
-    void VisibleLine();
+    // What each dot does, by the type of line it's on. Actions are run in the order the bits are listed. Horizontal and
+    // vertical transfers only happen on sprite fetch dots.
+    enum LineType : uint8_t
+    {
+        VISIBLE_LINE,
+        LAST_VISIBLE_LINE,
+        IDLE_LINE,
+        VBLANK_START_LINE,
+        VBLANK_END_LINE,
+        PRE_RENDER_LINE,
+        LINE_TYPE_COUNT
+    };
+
+    static constexpr uint16_t RESET_SPRITE_EVALUATION = 0x0001;
+    static constexpr uint16_t CLEAR_VBLANK = 0x0002;
+    static constexpr uint16_t NAMETABLE_READ = 0x0004;              // Unused nametable fetches
+    static constexpr uint16_t RENDERING_NAMETABLE_READ = 0x0008;    // Only while rendering is enabled
+    static constexpr uint16_t EVEN_FRAME_NAMETABLE_READ = 0x0010;   // Only while rendering is enabled on even frames
+    static constexpr uint16_t BACKGROUND_FETCH = 0x0020;
+    static constexpr uint16_t SPRITE_EVALUATION = 0x0040;
+    static constexpr uint16_t RENDER_PIXEL = 0x0080;
+    static constexpr uint16_t TRANSFER_HORIZONTAL = 0x0100;
+    static constexpr uint16_t TRANSFER_VERTICAL = 0x0200;
+    static constexpr uint16_t SPRITE_FETCH = 0x0400;
+    static constexpr uint16_t FRAME_READY = 0x0800;
+    static constexpr uint16_t SET_VBLANK = 0x1000;
+    static constexpr uint16_t CLEAR_SPRITE_FLAGS = 0x2000;
+
+    static constexpr uint16_t LINE_START_ACTIONS = RESET_SPRITE_EVALUATION | CLEAR_VBLANK | NAMETABLE_READ |
+                                                   RENDERING_NAMETABLE_READ | EVEN_FRAME_NAMETABLE_READ;
+    static constexpr uint16_t LINE_END_ACTIONS = FRAME_READY | SET_VBLANK | CLEAR_SPRITE_FLAGS;
+
+    using DotTable = std::array<std::array<uint16_t, 341>, LINE_TYPE_COUNT>;
+
+    static constexpr std::array<uint8_t, 262> CreateLineTypeTable();
+    static constexpr DotTable CreateDotTable();
+    static constexpr DotTable CreateIdleDotTable();
+    static const std::array<uint8_t, 262> LINE_TYPES;
+    static const DotTable DOT_ACTIONS;
+    static const DotTable IDLE_DOTS;
+
+    void ClockDot();
+    void RunDotActions(uint16_t actions);
+    void RenderTile();
 
 // Pointer increments
 private:
@@ -139,9 +183,18 @@ private:
     bool attributeTableLatchLow_;
 
     void BackgroundFetch();
+    void FetchNametableByte();
+    void FetchAttributeTableByte();
+    void FetchPatternTableLowByte();
+    void FetchPatternTableHighByte();
     void LoadShiftRegisters();
     void ShiftRegisters();
-    uint16_t NameTableAddress(uint16_t addr);
+// Nametables
+private:
+    std::array<uint8_t*, 4> nametablePages_ {};    // 1KB pages of VRAM_ mapped to $2000, $2400, $2800, and $2C00
+
+    void SetNametablePages(MirrorType mirrorType);
+    uint8_t& Nametable(uint16_t addr) { return nametablePages_[(addr >> 10) & 0x03][addr & 0x03FF]; }
 
 // Sprite evaluation
 private:
@@ -164,6 +217,7 @@ private:
 
     void ResetSpriteEvaluation();
     void SpriteEvaluation();
+    void EvaluateSprites();
 
 // Sprite fetch
 private:
@@ -182,10 +236,24 @@ private:
         bool valid;
         uint8_t patternTableLowByte;
         uint8_t patternTableHighByte;
+        uint64_t pixels;    // Decoded row, flip already applied
     };
     std::array<Sprite, 8> Sprites_;
     void SpriteFetch();
 
+// Sprite line buffer
+private:
+    // Sprite pixels for the next line to be rendered, indexed by dot. Bits 0-3 are the palette entry, which is 0 where no
+    // sprite is opaque. Composed from Sprites_ once all eight have been fetched.
+    static constexpr uint8_t SPRITE_LINE_PRIORITY = BACKGROUND_PRIORITY_MASK;
+    static constexpr uint8_t SPRITE_LINE_SPRITE_0 = 0x40;
+
+    std::array<uint8_t, 256> spriteLine_;
+    bool spritesOnLine_;
+    bool sprite0OnLine_;
+
+    void ComposeSpriteLine();
+
 // Pixel retrieval
 private:
     uint16_t backgroundPixelAddr_;
@@ -193,10 +261,21 @@ private:
     bool backgroundPriority_;
 
     void CreateBackgroundPixel();
+    uint64_t CreateBackgroundPixels();
     void CreateSpritePixel();
-    RGB PixelMultiplexer();
+    uint16_t PixelMultiplexer();
     void RenderPixel();
 
+// Pattern decoding
+private:
+    // A pattern table row decoded to one 2 bit pixel per byte, leftmost pixel in the least significant byte. Decoding only
+    // depends on the two bytes fetched, so the tables never need invalidating on bank switches or CHR RAM writes.
+    static constexpr std::array<uint64_t, 256> CreatePatternRowTable(bool flipped);
+    static const std::array<uint64_t, 256> PATTERN_ROWS;
+    static const std::array<uint64_t, 256> FLIPPED_PATTERN_ROWS;
+
+    static uint64_t DecodePatternRow(uint8_t lowByte, uint8_t highByte, bool flipped);
+
 // Other components
 private:
     Cartridge* cartridge_;
@@ -239,9 +318,27 @@ private:
 // Frame buffer
 private:
     bool frameReady_;
-    uint8_t* frameBuffer_;
+    uint16_t* frameBuffer_;     // 256x240 palette indexed pixels, see FrameConverter.hpp
     size_t framePointer_;
-    bool overscan_;
+
+    // Skipped frames still run every fetch and sprite evaluation, but only generate pixels on lines where sprite 0 can
+    // still hit. What lands in the frame buffer is garbage, so the NES doesn't hand these frames out.
+    bool frameSkipped_;
+
+    // While nothing that affects pixels changes, a frame comes out identical to the one before it. Reused frames are run
+    // like skipped ones, and the NES hands out the previous frame again. As soon as something does change, what's been
+    // output so far is copied from the previous frame and the rest is drawn as usual.
+    uint16_t const* reusedFrame_;   // Previous frame while the current one is being reused, otherwise nullptr
+    bool lastFrameReused_;
+    bool frameChanged_;             // Something affecting pixels changed since the last FrameChanged() call
+
+    void SetFrameChanged();
+
+    // Color subcarrier phase the current frame started on, in samples of 8 per dot and 12 per subcarrier cycle. Lines
+    // are 341 dots, so each one starts 4 samples later than the last.
+    uint8_t framePhase_;
+
+    bool PixelsNeeded() const;
 
 // Special mappers
 private:
@@ -6,20 +6,22 @@
 #include <cstdint>
 #include <fstream>
 
-class PulseChannel : public virtual AudioChannel
+class PulseChannel final : public AudioChannel
 {
 public:
     PulseChannel(bool onesComplement);
     void Reset() override;
 
-    uint8_t GetOutput() override;
-    void SetEnabled(bool enabled) override;
+    uint8_t GetOutput() const;
+    void SetEnabled(bool enabled);
 
-    void Clock() override;
-    void HalfFrameClock() override;
-    void QuarterFrameClock() override;
+    void Clock();
+    void Run(int clocks);
+    int ClocksUntilOutputChange() const;
+    void HalfFrameClock();
+    void QuarterFrameClock();
 
-    void RegisterUpdate(uint16_t addr, uint8_t data) override;
+    void RegisterUpdate(uint16_t addr, uint8_t data);
 
     void Serialize(std::ofstream& saveState) override;
     void Deserialize(std::ifstream& saveState) override;
@@ -32,11 +34,6 @@ private:
         {1, 0, 0, 1, 1, 1, 1, 1}
     };
 
-// Sequencer
-private:
-    size_t dutyCycleIndex_;
-    size_t sequencerIndex_;
-
 // Timer
 private:
     uint8_t timerReloadLow_;
@@ -46,6 +43,11 @@ private:
 
     void SetPeriod();
 
+// Sequencer
+private:
+    size_t dutyCycleIndex_;
+    size_t sequencerIndex_;
+
 // Envelope
 private:
     bool silenced_;
@@ -0,0 +1,60 @@
+#ifndef RESAMPLER_HPP
+#define RESAMPLER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Converts a stream of samples from one rate to another with a polyphase FIR filter. Each output sample is the dot
+// product of the input around it with a windowed sinc kernel for where it falls between two input samples, low passed
+// at whichever of the two rates is lower. Samples go in and come out in blocks of any size.
+class Resampler
+{
+public:
+    Resampler();
+    ~Resampler() = default;
+
+    // Can be changed between blocks without losing samples already written. The kernels are only redesigned when the
+    // ratio moves far enough to change the cutoff noticeably, so small adjustments to hold a buffer level are cheap.
+    void SetRates(double inputRate, double outputRate);
+    void Clear();
+
+    size_t InputNeeded(size_t count) const;     // Input samples to write before count output samples can be read
+    void Write(int16_t const* samples, size_t count);
+    size_t Read(int16_t* samples, size_t count);
+
+    size_t GetTapCount() const;
+
+private:
+    void DesignKernels(double scale);
+    float Convolve(float const* input, float const* kernel, float const* nextKernel, float fraction) const;
+
+// Position
+private:
+    // Fixed point with POSITION_BITS of fraction, in input samples from the start of input_. The top PHASE_BITS of the
+    // fraction pick the two kernels an output sample is interpolated between.
+    static constexpr int POSITION_BITS = 32;
+    static constexpr int PHASE_BITS = 6;
+    static constexpr size_t PHASE_COUNT = 1 << PHASE_BITS;
+
+    uint64_t position_;
+    uint64_t step_;     // Input samples per output sample
+
+// Kernels
+private:
+    static constexpr double CUTOFF = 0.45;          // Fraction of the lower rate passed
+    static constexpr double KERNEL_ZEROS = 16.0;    // Zero crossings of the sinc on either side of its center
+    static constexpr double REDESIGN_RATIO = 1.02;  // Change in the lower rate's share of the input rate to redesign at
+
+    // PHASE_COUNT + 1 kernels of tapCount_ taps each, the last one being the first shifted over by a sample so every
+    // phase has a next to interpolate towards. The tap count is a multiple of 4.
+    std::vector<float> kernels_;
+    size_t tapCount_;
+    double scale_;  // Output rate over input rate the kernels were designed for, at most 1
+
+// Samples
+private:
+    std::vector<float> input_;  // Input from the sample the next output starts on
+};
+
+#endif
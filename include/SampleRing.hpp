@@ -0,0 +1,39 @@
+#ifndef SAMPLERING_HPP
+#define SAMPLERING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Lock-free queue of audio samples between exactly one writing thread and one reading thread. Each side only ever
+// advances its own index, so neither has to wait on the other.
+class SampleRing
+{
+public:
+    SampleRing(size_t capacity);    // Rounded up to a power of two
+    ~SampleRing() = default;
+
+    // Writer only. Returns the number of samples written, fewer than count if the ring fills up.
+    size_t Write(int16_t const* samples, size_t count);
+    size_t WriteSilence(size_t count);
+
+    // Reader only. Returns the number of samples read, fewer than count if the ring runs out.
+    size_t Read(int16_t* samples, size_t count);
+
+    // Safe from either side, but only exact on the writer's side for what has been read and vice versa
+    size_t Size() const;
+    size_t Capacity() const;
+
+private:
+    std::vector<int16_t> buffer_;
+    size_t mask_;
+
+    size_t Push(int16_t const* samples, size_t count);
+
+    // Total samples ever written and read. On separate cache lines so the two threads don't contend over them.
+    alignas(64) std::atomic<size_t> writeIndex_;
+    alignas(64) std::atomic<size_t> readIndex_;
+};
+
+#endif
@@ -0,0 +1,161 @@
+#ifndef SCALER_HPP
+#define SCALER_HPP
+
+#include "FrameConverter.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pixel art scalers for frames converted to 32 bit pixels by FrameConverter
+enum class ScalerType
+{
+    NONE,
+    SCALE2X,
+    SCALE3X,
+    HQ2X,
+    HQ3X,
+    XBR2X
+};
+
+constexpr size_t SCALER_COUNT = 6;
+
+constexpr size_t ScaleFactor(ScalerType type)
+{
+    if (type == ScalerType::NONE)
+    {
+        return 1;
+    }
+
+    return ((type == ScalerType::SCALE3X) || (type == ScalerType::HQ3X)) ? 3 : 2;
+}
+
+char const* ScalerName(ScalerType type);
+
+class ThreadPool
+{
+public:
+    // threads counts the calling thread, which works on jobs alongside the pool
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    size_t ThreadCount() const;
+
+    // Run job(i) for each i in [0, count) and return once they've all finished
+    void ParallelFor(size_t count, std::function<void(size_t)> const& job);
+
+private:
+    void WorkerLoop();
+    void RunJobs();
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable startCondition_;
+    std::condition_variable doneCondition_;
+
+    std::function<void(size_t)> const* job_;
+    size_t jobCount_;
+    std::atomic<size_t> nextJob_;
+    size_t busyWorkers_;
+    uint64_t generation_;
+    bool stopping_;
+};
+
+class Scaler
+{
+public:
+    explicit Scaler(size_t threads = DefaultThreadCount());
+    ~Scaler() = default;
+
+    // Small enough to leave cores for emulation and the rest of the presenter
+    static size_t DefaultThreadCount();
+
+    size_t ThreadCount() const;
+
+    // Scale a FRAME_WIDTH x FRAME_HEIGHT frame of BGRA8888 pixels. pitch is the number of bytes between the starts of two
+    // rows in pixels, which must hold ScaleFactor(type) times as many rows and columns.
+    void Scale(ScalerType type, uint32_t const* frame, uint8_t* pixels, size_t pitch);
+
+private:
+    // Rows of the source frame handed to each job
+    static constexpr size_t BAND_HEIGHT = 16;
+    static constexpr size_t BAND_COUNT = (FRAME_HEIGHT + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+    ThreadPool pool_;
+    std::unique_ptr<uint32_t[]> yuv_;   // Luma and chroma of each source pixel, used by HQx and xBR to compare pixels
+
+    void Scale2xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const;
+    void Scale3xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const;
+    void ConvertYuvRows(uint32_t const* frame, size_t firstRow, size_t endRow);
+    void Xbr2xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const;
+
+// HQx
+private:
+    // Each output pixel mixes the source pixel E with up to two of its neighbours, in 16ths. The rule for it is picked
+    // by which of the 8 neighbours differ from E by more than HQx's YUV thresholds and, where both neighbours beside a
+    // corner of E differ from it, whether they also differ from each other. Neighbours are numbered
+    // (dy + 1) * 3 + dx + 1.
+    struct HqRule
+    {
+        uint8_t weight;         // Of E
+        uint8_t first;
+        uint8_t firstWeight;
+        uint8_t second;
+        uint8_t secondWeight;
+    };
+
+    // Indexed by the pattern of differing neighbours, the output pixel, then a bit for each of the up to two corners
+    // the output pixel is next to, set when the neighbours beside that corner differ from each other
+    template <size_t Factor>
+    using HqRules = std::array<std::array<std::array<HqRule, 4>, Factor * Factor>, 256>;
+
+    template <size_t Factor>
+    static constexpr HqRules<Factor> CreateHqRules();
+    static const HqRules<2> HQ2X_RULES;
+    static const HqRules<3> HQ3X_RULES;
+
+    template <size_t Factor>
+    void HqRows(HqRules<Factor> const& rules, uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow,
+                size_t endRow) const;
+
+    // cornerDiffs has a bit for each corner of E, from top left to bottom right
+    template <size_t Factor>
+    static void HqPixel(HqRules<Factor> const& rules, std::array<uint32_t, 9> const& neighbours, uint8_t pattern,
+                        uint8_t cornerDiffs, std::array<uint32_t*, Factor> const& out, size_t x);
+
+// xBR
+private:
+    // Source pixels around the one being scaled are gathered into a 5x5 grid. The corner rules are written for the
+    // bottom right output pixel, and the grid and output block are rotated to apply them to the other three corners.
+    static constexpr size_t GRID_SIZE = 25;
+    using GridRotation = std::array<uint8_t, GRID_SIZE + 4>;    // Grid positions, then output block positions
+
+    static constexpr std::array<GridRotation, 4> CreateGridRotations();
+    static const std::array<GridRotation, 4> GRID_ROTATIONS;
+
+    // What Xbr2xCorner found at a corner, so it can be worked out for several pixels at once and blended one at a time
+    static constexpr uint8_t XBR_EDGE = 0x01;
+    static constexpr uint8_t XBR_LEFT = 0x02;
+    static constexpr uint8_t XBR_UP = 0x04;
+    static constexpr uint8_t XBR_TOWARD_F = 0x08;
+
+    static uint32_t YuvDistance(uint32_t a, uint32_t b);
+    static uint32_t Blend(uint32_t a, uint32_t b, uint32_t weight);
+    static uint8_t Xbr2xCorner(std::array<uint32_t, GRID_SIZE> const& pixels,
+                               std::array<uint32_t, GRID_SIZE> const& yuv,
+                               GridRotation const& rotation);
+    static void BlendXbr2xCorner(uint8_t corner,
+                                 std::array<uint32_t, GRID_SIZE> const& pixels,
+                                 GridRotation const& rotation,
+                                 std::array<uint32_t, 4>& block);
+    void Xbr2xBlock(uint32_t const* frame, std::array<size_t, 5> const& rowOffsets, size_t x,
+                    uint32_t* out0, uint32_t* out1) const;
+};
+
+#endif
@@ -6,20 +6,22 @@
 #include <cstdint>
 #include <fstream>
 
-class TriangleChannel : public virtual AudioChannel
+class TriangleChannel final : public AudioChannel
 {
 public:
     TriangleChannel();
     void Reset() override;
 
-    uint8_t GetOutput() override;
-    void SetEnabled(bool enabled) override;
+    uint8_t GetOutput() const;
+    void SetEnabled(bool enabled);
 
-    void Clock() override;
-    void HalfFrameClock() override;
-    void QuarterFrameClock() override;
+    void Clock();
+    void Run(int clocks);
+    int ClocksUntilOutputChange() const;
+    void HalfFrameClock();
+    void QuarterFrameClock();
 
-    void RegisterUpdate(uint16_t addr, uint8_t data) override;
+    void RegisterUpdate(uint16_t addr, uint8_t data);
 
     void Serialize(std::ofstream& saveState) override;
     void Deserialize(std::ifstream& saveState) override;
@@ -29,6 +31,15 @@ private:
     15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15
 };
 
+// Timer
+private:
+    uint8_t timerReloadLow_;
+    uint8_t timerReloadHigh_;
+    uint16_t timerReload_;
+    int timer_;
+
+    void SetPeriod();
+
 // Sequencer
 private:
     size_t sequencerIndex_;
@@ -39,15 +50,6 @@ private:
     bool reloadLinearCounterFlag_;
     uint8_t linearCounterReload_;
     int linearCounter_;
-
-// Timer
-private:
-    uint8_t timerReloadLow_;
-    uint8_t timerReloadHigh_;
-    uint16_t timerReload_;
-    int timer_;
-
-    void SetPeriod();
 };
 
 #endif
@@ -36,6 +36,7 @@ private:
     size_t prgIndex_;
 
     void LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks) override;
+    void UpdatePrgPages();
 };
 
 #endif
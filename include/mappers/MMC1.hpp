@@ -63,6 +63,7 @@ private:
     void LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks) override;
     void SetRegisters(uint16_t addr);
     void UpdateIndices();
+    void UpdatePrgPages();
 };
 
 #endif
@@ -52,9 +52,11 @@ private:
     uint8_t rightBankFD_;   // latch1_ == 0xFD
     uint8_t rightBankFE_;   // latch1_ == 0xFE
 
+    void SetChrBank(uint8_t& bank, uint8_t data);
     void UpdateChrBanks();
 
     void LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks) override;
+    void UpdatePrgPages();
 };
 
 #endif
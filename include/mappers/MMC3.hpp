@@ -45,6 +45,7 @@ public:
 
     void SaveRAM() override;
     bool IRQ() override;
+    size_t ChrReadsUntilIrq() override;
 
     void Serialize(std::ofstream& saveState) override;
     void Deserialize(std::ifstream& saveState) override;
@@ -75,6 +76,7 @@ private:
     bool chrBankMode_;
 
     void SetBanks();
+    void UpdatePrgPages();
 
 // RAM
 private:
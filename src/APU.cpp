@@ -4,27 +4,39 @@
 #include "../include/PulseChannel.hpp"
 #include "../include/RegisterAddresses.hpp"
 #include "../include/TriangleChannel.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
-#include <memory>
+#include <limits>
 #include <optional>
 
-APU::APU()
+APU::APU() :
+    pulseChannel1_(true),
+    pulseChannel2_(false),
+    channels_({&pulseChannel1_, &pulseChannel2_, &triangleChannel_, &noiseChannel_})
 {
-    pulseTable_[0] = 0.0;
+    pulseLevels_[0] = 0;
 
     for (size_t n = 1; n < 31; ++n)
     {
-        pulseTable_[n] = 95.52 / ((8128.0 / n) + 100);
+        pulseLevels_[n] = std::lround(95.52 / ((8128.0 / n) + 100) * 0xFFFF);
     }
 
-    tndTable_[0] = 0.0;
+    tndLevels_[0] = 0;
 
     for (size_t n = 1; n < 203; ++n)
     {
-        tndTable_[n] = 163.67 / ((24329.0 / n) + 100);
+        tndLevels_[n] = std::lround(163.67 / ((24329.0 / n) + 100) * 0xFFFF);
     }
 
+    amplitude_ = 0;
+    audioCycle_ = 0;
+    blipBuffer_.SetRates(1789773.0, INTERNAL_SAMPLE_RATE);
+    resampler_.SetRates(INTERNAL_SAMPLE_RATE, 44100.0);
+    pendingCycles_ = 0;
+
     irq_ = false;
     clockAPU_ = false;
     frameCounterMode_ = false;
@@ -32,77 +44,97 @@ APU::APU()
     frameCounterTimer_ = 0;
     frameCounterResetCountdown_ = 0;
 
-    CHANNELS_[0] = std::make_unique<PulseChannel>(true);
-    CHANNELS_[1] = std::make_unique<PulseChannel>(false);
-    CHANNELS_[2] = std::make_unique<TriangleChannel>();
-    CHANNELS_[3] = std::make_unique<NoiseChannel>();
-    dmcChannel_ = std::make_unique<DmcChannel>();
-
-    pulseChannel1_ = dynamic_cast<PulseChannel*>(CHANNELS_[0].get());
-    pulseChannel2_ = dynamic_cast<PulseChannel*>(CHANNELS_[1].get());
-    triangleChannel_ = dynamic_cast<TriangleChannel*>(CHANNELS_[2].get());
-    noiseChannel_ = dynamic_cast<NoiseChannel*>(CHANNELS_[3].get());
+    UpdateSyncDeadline();
 }
 
 void APU::Clock()
 {
-    clockAPU_ = !clockAPU_;
-
-    if (frameCounterResetCountdown_ > 0)
+    if (++pendingCycles_ >= syncDeadline_)
     {
-        --frameCounterResetCountdown_;
-
-        if (frameCounterResetCountdown_ == 0)
-        {
-            frameCounterTimer_ = 0;
-        }
+        Sync();
     }
+}
 
-    triangleChannel_->Clock();
+void APU::Run(size_t cycles)
+{
+    pendingCycles_ += cycles;
 
-    if (!clockAPU_)
+    if (pendingCycles_ >= syncDeadline_)
     {
-        return;
+        Sync();
     }
-
-    pulseChannel1_->Clock();
-    pulseChannel2_->Clock();
-    noiseChannel_->Clock();
-    dmcChannel_->Clock();
-    ClockFrameCounter();
 }
 
 void APU::Reset()
 {
-    for (std::unique_ptr<AudioChannel>& channel : CHANNELS_)
+    Sync();
+
+    for (AudioChannel* channel : channels_)
     {
         channel->Reset();
     }
 
-    dmcChannel_->Reset();
+    dmcChannel_.Reset();
+    UpdateAmplitude();
+    UpdateSyncDeadline();
 }
 
-int16_t APU::GetSample()
+void APU::SetAudioRates(double clockRate, double sampleRate)
 {
-    float pulseOut = pulseTable_[pulseChannel1_->GetOutput() + pulseChannel2_->GetOutput()];
-    float tndOut = tndTable_[(3 * triangleChannel_->GetOutput()) + (2 * noiseChannel_->GetOutput()) + dmcChannel_->GetOutput()];
-    int16_t signedOut = ((pulseOut + tndOut) * 0xFFFF) - 0x8000;
-    return signedOut;
+    // Steps already recorded are placed at the old rates
+    Sync();
+    EndAudioBlock();
+    blipBuffer_.SetRates(clockRate, INTERNAL_SAMPLE_RATE);
+    resampler_.SetRates(INTERNAL_SAMPLE_RATE, sampleRate);
+}
+
+size_t APU::CyclesUntilSamples(size_t count)
+{
+    Sync();
+    EndAudioBlock();
+    return blipBuffer_.ClocksUntilSamples(resampler_.InputNeeded(count));
+}
+
+size_t APU::ReadSamples(int16_t* buffer, size_t count)
+{
+    // Output is centered on silence, with a DC blocking filter taking the place of the NES's own
+    Sync();
+    EndAudioBlock();
+
+    // Only as much goes through the resampler as it needs, the rest waits in the blip buffer
+    std::array<int16_t, 1024> internal;
+    size_t needed = resampler_.InputNeeded(count);
+
+    while (needed > 0)
+    {
+        size_t samplesRead = blipBuffer_.ReadSamples(internal.data(), std::min(needed, internal.size()));
+
+        if (samplesRead == 0)
+        {
+            break;
+        }
+
+        resampler_.Write(internal.data(), samplesRead);
+        needed -= samplesRead;
+    }
+
+    return resampler_.Read(buffer, count);
 }
 
 uint8_t APU::ReadReg(uint16_t addr)
 {
+    Sync();
     uint8_t returnData = 0x00;
 
     if (addr == SND_CHN_ADDR)
     {
-        returnData |= (pulseChannel1_->GetLengthCounter() > 0) ? 0x01 : 0x00;
-        returnData |= (pulseChannel2_->GetLengthCounter() > 0) ? 0x02 : 0x00;
-        returnData |= (triangleChannel_->GetLengthCounter() > 0) ? 0x04 : 0x00;
-        returnData |= (noiseChannel_->GetLengthCounter() > 0) ? 0x08 : 0x00;
-        returnData |= (dmcChannel_->GetBytesRemaining() > 0) ? 0x10 : 0x00;
+        returnData |= (pulseChannel1_.GetLengthCounter() > 0) ? 0x01 : 0x00;
+        returnData |= (pulseChannel2_.GetLengthCounter() > 0) ? 0x02 : 0x00;
+        returnData |= (triangleChannel_.GetLengthCounter() > 0) ? 0x04 : 0x00;
+        returnData |= (noiseChannel_.GetLengthCounter() > 0) ? 0x08 : 0x00;
+        returnData |= (dmcChannel_.GetBytesRemaining() > 0) ? 0x10 : 0x00;
         returnData |= irq_ ? 0x40 : 0x00;
-        returnData |= dmcChannel_->IRQ() ? 0x80 : 0x00;
+        returnData |= dmcChannel_.IRQ() ? 0x80 : 0x00;
         irq_ = false;
     }
 
@@ -111,42 +143,44 @@ uint8_t APU::ReadReg(uint16_t addr)
 
 void APU::WriteReg(uint16_t addr, uint8_t data)
 {
+    Sync();
+
     switch (addr)
     {
         case SQ1_VOL_ADDR:
         case SQ1_SWEEP_ADDR:
         case SQ1_LO_ADDR:
         case SQ1_HI_ADDR:
-            pulseChannel1_->RegisterUpdate(addr, data);
+            pulseChannel1_.RegisterUpdate(addr, data);
             break;
         case SQ2_VOL_ADDR:
         case SQ2_SWEEP_ADDR:
         case SQ2_LO_ADDR:
         case SQ2_HI_ADDR:
-            pulseChannel2_->RegisterUpdate(addr, data);
+            pulseChannel2_.RegisterUpdate(addr, data);
             break;
         case TRI_LINEAR_ADDR:
         case TRI_LO_ADDR:
         case TRI_HI_ADDR:
-            triangleChannel_->RegisterUpdate(addr, data);
+            triangleChannel_.RegisterUpdate(addr, data);
             break;
         case NOISE_VOL_ADDR:
         case NOISE_LO_ADDR:
         case NOISE_HI_ADDR:
-            noiseChannel_->RegisterUpdate(addr, data);
+            noiseChannel_.RegisterUpdate(addr, data);
             break;
         case DMC_FREQ_ADDR:
         case DMC_RAW_ADDR:
         case DMC_START_ADDR:
         case DMC_LEN_ADDR:
-            dmcChannel_->RegisterUpdate(addr, data);
+            dmcChannel_.RegisterUpdate(addr, data);
             break;
         case SND_CHN_ADDR:
-            pulseChannel1_->SetEnabled((data & 0x01) == 0x01);
-            pulseChannel2_->SetEnabled((data & 0x02) == 0x02);
-            triangleChannel_->SetEnabled((data & 0x04) == 0x04);
-            noiseChannel_->SetEnabled((data & 0x08) == 0x08);
-            dmcChannel_->SetEnabled((data & 0x10) == 0x10);
+            pulseChannel1_.SetEnabled((data & 0x01) == 0x01);
+            pulseChannel2_.SetEnabled((data & 0x02) == 0x02);
+            triangleChannel_.SetEnabled((data & 0x04) == 0x04);
+            noiseChannel_.SetEnabled((data & 0x08) == 0x08);
+            dmcChannel_.SetEnabled((data & 0x10) == 0x10);
             break;
         case FRAME_COUNTER_ADDR:
             frameCounterMode_ = (data & 0x80) == 0x80;
@@ -169,25 +203,49 @@ void APU::WriteReg(uint16_t addr, uint8_t data)
             }
             break;
     }
+
+    // Clocking the channels would have picked up the change on the next cycle
+    UpdateAmplitude();
+    UpdateSyncDeadline();
 }
 
 bool APU::IRQ()
 {
-    return (irq_ || dmcChannel_->IRQ());
+    return (irq_ || dmcChannel_.IRQ());
 }
 
 std::optional<uint16_t> APU::DmcRequestSample()
 {
-    return dmcChannel_->RequestSample();
+    return dmcChannel_.RequestSample();
+}
+
+size_t APU::CyclesUntilEvent()
+{
+    // CPU cycles that can run before a DMC sample request or frame counter IRQ. Both are driven by APU cycles, which occur
+    // on every other CPU cycle, so n APU cycles take at least 2n - 1 CPU cycles.
+    int apuCycles = dmcChannel_.CyclesUntilRequest();
+
+    if (!frameCounterMode_ && !irqInhibit_ && !irq_)
+    {
+        apuCycles = std::min(apuCycles, (frameCounterTimer_ < 14915) ? (14915 - frameCounterTimer_) : 0);
+    }
+
+    size_t cycles = (apuCycles == 0) ? 0 : ((2 * static_cast<size_t>(apuCycles)) - 2);
+
+    // Counted from the last catch-up
+    return (cycles > pendingCycles_) ? (cycles - pendingCycles_) : 0;
 }
 
 void APU::SetDmcSample(uint8_t sample)
 {
-    dmcChannel_->SetSample(sample);
+    Sync();
+    dmcChannel_.SetSample(sample);
+    UpdateSyncDeadline();
 }
 
 void APU::Serialize(std::ofstream& saveState)
 {
+    Sync();
     saveState.write((char*)&irq_, sizeof(irq_));
     saveState.write((char*)&clockAPU_, sizeof(clockAPU_));
     saveState.write((char*)&frameCounterMode_, sizeof(frameCounterMode_));
@@ -195,12 +253,12 @@ void APU::Serialize(std::ofstream& saveState)
     saveState.write((char*)&frameCounterTimer_, sizeof(frameCounterTimer_));
     saveState.write((char*)&frameCounterResetCountdown_, sizeof(frameCounterResetCountdown_));
 
-    for (std::unique_ptr<AudioChannel>& channel : CHANNELS_)
+    for (AudioChannel* channel : channels_)
     {
         channel->Serialize(saveState);
     }
 
-    dmcChannel_->Serialize(saveState);
+    dmcChannel_.Serialize(saveState);
 }
 
 void APU::Deserialize(std::ifstream& saveState)
@@ -212,12 +270,15 @@ void APU::Deserialize(std::ifstream& saveState)
     saveState.read((char*)&frameCounterTimer_, sizeof(frameCounterTimer_));
     saveState.read((char*)&frameCounterResetCountdown_, sizeof(frameCounterResetCountdown_));
 
-    for (std::unique_ptr<AudioChannel>& channel : CHANNELS_)
+    for (AudioChannel* channel : channels_)
     {
         channel->Deserialize(saveState);
     }
 
-    dmcChannel_->Deserialize(saveState);
+    dmcChannel_.Deserialize(saveState);
+    pendingCycles_ = 0;
+    UpdateAmplitude();
+    UpdateSyncDeadline();
 }
 
 void APU::ClockFrameCounter()
@@ -256,18 +317,194 @@ void APU::ClockFrameCounter()
     }
 }
 
-void APU::HalfFrameClock()
+size_t APU::CyclesUntilFrameCounterStep() const
+{
+    // CPU cycles until the next one that does more than count up the frame counter. Each cycle of a reset countdown is
+    // stepped through on its own.
+    if (frameCounterResetCountdown_ > 0)
+    {
+        return 1;
+    }
+
+    for (int step : FRAME_COUNTER_STEPS)
+    {
+        if (step > frameCounterTimer_)
+        {
+            return CyclesUntilApuCycle(step - frameCounterTimer_);
+        }
+    }
+
+    return std::numeric_limits<size_t>::max();
+}
+
+void APU::Sync()
 {
-    for (std::unique_ptr<AudioChannel>& channel : CHANNELS_)
+    // Catch up on pending cycles, stepping cycles that clock the frame counter one at a time and running the channels
+    // alone in between
+    size_t cycles = pendingCycles_;
+    pendingCycles_ = 0;
+
+    while (cycles > 0)
     {
-        channel->HalfFrameClock();
+        size_t span = std::min(cycles, CyclesUntilFrameCounterStep() - 1);
+
+        if (span == 0)
+        {
+            Tick();
+            --cycles;
+            continue;
+        }
+
+        frameCounterTimer_ += clockAPU_ ? (span / 2) : ((span + 1) / 2);
+        RunChannels(span);
+        cycles -= span;
     }
+
+    UpdateSyncDeadline();
 }
 
-void APU::QuarterFrameClock()
+void APU::UpdateSyncDeadline()
 {
-    for (std::unique_ptr<AudioChannel>& channel : CHANNELS_)
+    // A pending DMC request stays pending until the CPU answers it with SetDmcSample()
+    syncDeadline_ = CyclesUntilFrameCounterStep();
+    int dmcCycles = dmcChannel_.CyclesUntilRequest();
+
+    if (dmcCycles > 0)
     {
-        channel->QuarterFrameClock();
+        syncDeadline_ = std::min(syncDeadline_, CyclesUntilApuCycle(dmcCycles));
     }
 }
+
+void APU::Tick()
+{
+    if (frameCounterResetCountdown_ > 0)
+    {
+        --frameCounterResetCountdown_;
+
+        if (frameCounterResetCountdown_ == 0)
+        {
+            frameCounterTimer_ = 0;
+        }
+    }
+
+    ClockChannels();
+
+    if (clockAPU_)
+    {
+        ClockFrameCounter();
+    }
+
+    UpdateAmplitude();
+    AdvanceAudio(1);
+}
+
+void APU::RunChannels(size_t cycles)
+{
+    // The cycles a channel's output could change on are clocked one at a time, and everything between them is skipped
+    while (cycles > 0)
+    {
+        size_t blockCycles = AUDIO_BLOCK_CYCLES - audioCycle_;
+        size_t quiet = std::min({cycles, CyclesUntilOutputChange() - 1, blockCycles});
+
+        if (quiet == 0)
+        {
+            ClockChannels();
+            UpdateAmplitude();
+            AdvanceAudio(1);
+            --cycles;
+            continue;
+        }
+
+        int apuCycles = clockAPU_ ? (quiet / 2) : ((quiet + 1) / 2);
+
+        if ((quiet % 2) == 1)
+        {
+            clockAPU_ = !clockAPU_;
+        }
+
+        triangleChannel_.Run(quiet);
+        pulseChannel1_.Run(apuCycles);
+        pulseChannel2_.Run(apuCycles);
+        noiseChannel_.Run(apuCycles);
+        dmcChannel_.Run(apuCycles);
+        AdvanceAudio(quiet);
+        cycles -= quiet;
+    }
+}
+
+void APU::ClockChannels()
+{
+    clockAPU_ = !clockAPU_;
+    triangleChannel_.Clock();
+
+    if (clockAPU_)
+    {
+        pulseChannel1_.Clock();
+        pulseChannel2_.Clock();
+        noiseChannel_.Clock();
+        dmcChannel_.Clock();
+    }
+}
+
+size_t APU::CyclesUntilApuCycle(int apuCycles) const
+{
+    // APU cycles happen on the CPU cycles that set clockAPU_
+    return (2 * static_cast<size_t>(apuCycles)) - (clockAPU_ ? 0 : 1);
+}
+
+size_t APU::CyclesUntilOutputChange() const
+{
+    int apuClocks = std::min({pulseChannel1_.ClocksUntilOutputChange(),
+                              pulseChannel2_.ClocksUntilOutputChange(),
+                              noiseChannel_.ClocksUntilOutputChange(),
+                              dmcChannel_.ClocksUntilOutputChange()});
+
+    return std::min(static_cast<size_t>(triangleChannel_.ClocksUntilOutputChange()), CyclesUntilApuCycle(apuClocks));
+}
+
+void APU::UpdateAmplitude()
+{
+    int pulseOut = pulseLevels_[pulseChannel1_.GetOutput() + pulseChannel2_.GetOutput()];
+    int tndOut = tndLevels_[(3 * triangleChannel_.GetOutput()) + (2 * noiseChannel_.GetOutput()) +
+                            dmcChannel_.GetOutput()];
+    int amplitude = pulseOut + tndOut;
+
+    if (amplitude != amplitude_)
+    {
+        blipBuffer_.AddDelta(audioCycle_, amplitude - amplitude_);
+        amplitude_ = amplitude;
+    }
+}
+
+void APU::AdvanceAudio(size_t cycles)
+{
+    // Blocks are only ever advanced up to their end
+    audioCycle_ += cycles;
+
+    if (audioCycle_ == AUDIO_BLOCK_CYCLES)
+    {
+        EndAudioBlock();
+    }
+}
+
+void APU::EndAudioBlock()
+{
+    blipBuffer_.EndFrame(audioCycle_);
+    audioCycle_ = 0;
+}
+
+void APU::HalfFrameClock()
+{
+    pulseChannel1_.HalfFrameClock();
+    pulseChannel2_.HalfFrameClock();
+    triangleChannel_.HalfFrameClock();
+    noiseChannel_.HalfFrameClock();
+}
+
+void APU::QuarterFrameClock()
+{
+    pulseChannel1_.QuarterFrameClock();
+    pulseChannel2_.QuarterFrameClock();
+    triangleChannel_.QuarterFrameClock();
+    noiseChannel_.QuarterFrameClock();
+}
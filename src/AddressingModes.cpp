@@ -9,7 +9,7 @@ void CPU::Immediate()
             iData_ = ReadAndIncrementPC();
             break;
         case 2:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -35,7 +35,7 @@ void CPU::Absolute()
             }
             break;
         case 4:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -58,7 +58,7 @@ void CPU::ZeroPage()
             }
             break;
         case 3:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -72,7 +72,7 @@ void CPU::Implied()
             Read(Registers_.programCounter);
             break;
         case 2:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -112,7 +112,7 @@ void CPU::AbsoluteIndexed()
             }
             break;
         case 5:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -140,7 +140,7 @@ void CPU::ZeroPageIndexed()
             }
             break;
         case 4:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -175,7 +175,7 @@ void CPU::IndirectX()
             }
             break;
         case 6:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -219,7 +219,7 @@ void CPU::IndirectY()
             }
             break;
         case 6:
-            instruction_();
+            (this->*instruction_)();
             SetNextOpCode();
     }
 }
@@ -271,7 +271,7 @@ void CPU::Accumulator()
             iData_ = Registers_.accumulator;
             break;
         case 2:
-            instruction_();
+            (this->*instruction_)();
             Registers_.accumulator = iData_;
             SetNextOpCode();
     }
@@ -292,7 +292,7 @@ void CPU::ZeroPageRMW()
             Write(iAddr_, 0xFF);
             break;
         case 4:
-            instruction_();
+            (this->*instruction_)();
             Write(iAddr_, iData_);
             break;
         case 5:
@@ -320,7 +320,7 @@ void CPU::ZeroPageIndexedRMW()
             Write(iAddr_, 0xFF);
             break;
         case 5:
-            instruction_();
+            (this->*instruction_)();
             Write(iAddr_, iData_);
             break;
         case 6:
@@ -346,7 +346,7 @@ void CPU::AbsoluteRWM()
             Write(iAddr_, 0xFF);
             break;
         case 5:
-            instruction_();
+            (this->*instruction_)();
             Write(iAddr_, iData_);
             break;
         case 6:
@@ -377,7 +377,7 @@ void CPU::AbsoluteIndexedRMW()
             Write(iAddr_, 0xFF);
             break;
         case 6:
-            instruction_();
+            (this->*instruction_)();
             Write(iAddr_, iData_);
             break;
         case 7:
@@ -0,0 +1,155 @@
+#include "../include/BlipBuffer.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+}
+
+BlipBuffer::BlipBuffer() :
+    factor_(0),
+    offset_(0),
+    capacity_(0),
+    available_(0),
+    integrator_(0)
+{
+    // A step at fraction f of the way through sample 0 is centered at 7 + f. Tap k of its kernel is the band-limited
+    // impulse at k - 7 - f, Blackman windowed over the kernel's 16 samples.
+    constexpr double CENTER = (KERNEL_WIDTH / 2) - 1;
+    constexpr double HALF_WIDTH = KERNEL_WIDTH / 2;
+
+    for (size_t phase = 0; phase < PHASE_COUNT; ++phase)
+    {
+        std::array<double, KERNEL_WIDTH> taps;
+        double sum = 0.0;
+
+        for (size_t k = 0; k < KERNEL_WIDTH; ++k)
+        {
+            double x = k - CENTER - (static_cast<double>(phase) / PHASE_COUNT);
+            double sinc = (x == 0.0) ? 1.0 : (std::sin(2 * PI * CUTOFF * x) / (2 * PI * CUTOFF * x));
+            double window = 0.42 + (0.5 * std::cos(PI * x / HALF_WIDTH)) + (0.08 * std::cos(2 * PI * x / HALF_WIDTH));
+            taps[k] = sinc * window;
+            sum += taps[k];
+        }
+
+        int32_t total = 0;
+
+        for (size_t k = 0; k < KERNEL_WIDTH; ++k)
+        {
+            kernels_[phase][k] = std::lround(taps[k] * (1 << KERNEL_BITS) / sum);
+            total += kernels_[phase][k];
+        }
+
+        // Rounding error goes in the largest tap
+        kernels_[phase][KERNEL_WIDTH / 2] += (1 << KERNEL_BITS) - total;
+    }
+
+    SetRates(1789773.0, 44100.0);
+}
+
+void BlipBuffer::SetRates(double clockRate, double sampleRate)
+{
+    factor_ = std::llround(sampleRate / clockRate * (uint64_t{1} << TIME_BITS));
+    size_t capacity = std::lround(sampleRate * CAPACITY_SECONDS);
+
+    if (capacity != capacity_)
+    {
+        capacity_ = capacity;
+        available_ = std::min(available_, capacity_);
+        buffer_.resize((2 * capacity_) + KERNEL_WIDTH, 0);
+    }
+}
+
+void BlipBuffer::Clear()
+{
+    std::fill(buffer_.begin(), buffer_.end(), 0);
+    offset_ = 0;
+    available_ = 0;
+    integrator_ = 0;
+}
+
+void BlipBuffer::AddDelta(uint32_t time, int delta)
+{
+    uint64_t position = (time * factor_) + offset_;
+    size_t sample = available_ + (position >> TIME_BITS);
+    size_t phase = (position >> (TIME_BITS - PHASE_BITS)) & (PHASE_COUNT - 1);
+
+    // Frames are kept short enough that this only happens if the rates were wildly off
+    if (sample + KERNEL_WIDTH > buffer_.size())
+    {
+        return;
+    }
+
+    int64_t* out = &buffer_[sample];
+    std::array<int32_t, KERNEL_WIDTH> const& kernel = kernels_[phase];
+
+    for (size_t k = 0; k < KERNEL_WIDTH; ++k)
+    {
+        out[k] += static_cast<int64_t>(kernel[k]) * delta;
+    }
+}
+
+void BlipBuffer::EndFrame(uint32_t time)
+{
+    uint64_t position = (time * factor_) + offset_;
+    available_ += position >> TIME_BITS;
+    offset_ = position & ((uint64_t{1} << TIME_BITS) - 1);
+
+    // Samples nobody read in time are dropped, oldest first
+    if (available_ > capacity_)
+    {
+        Integrate(nullptr, available_ - capacity_);
+    }
+}
+
+size_t BlipBuffer::SamplesAvailable() const
+{
+    return available_;
+}
+
+uint32_t BlipBuffer::ClocksUntilSamples(size_t count) const
+{
+    if (count <= available_)
+    {
+        return 0;
+    }
+
+    uint64_t needed = (static_cast<uint64_t>(count - available_) << TIME_BITS) - offset_;
+    return (needed + factor_ - 1) / factor_;
+}
+
+size_t BlipBuffer::ReadSamples(int16_t* buffer, size_t count)
+{
+    count = std::min(count, available_);
+    Integrate(buffer, count);
+    return count;
+}
+
+void BlipBuffer::Integrate(int16_t* buffer, size_t count)
+{
+    // Sum up count samples, writing them to buffer if there is one, and drop them from the front
+    int64_t integrator = integrator_;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        integrator += buffer_[i];
+        int64_t sample = integrator >> KERNEL_BITS;
+
+        if (buffer != nullptr)
+        {
+            buffer[i] = std::clamp<int64_t>(sample, INT16_MIN, INT16_MAX);
+        }
+
+        integrator -= sample << (KERNEL_BITS - BASS_SHIFT);
+    }
+
+    integrator_ = integrator;
+    std::copy(buffer_.begin() + count, buffer_.begin() + available_ + KERNEL_WIDTH, buffer_.begin());
+    std::fill(buffer_.begin() + available_ + KERNEL_WIDTH - count, buffer_.begin() + available_ + KERNEL_WIDTH, 0);
+    available_ -= count;
+}
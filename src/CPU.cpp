@@ -2,31 +2,31 @@
 #include "../include/APU.hpp"
 #include "../include/Cartridge.hpp"
 #include "../include/Controller.hpp"
+#include "../include/CpuTrace.hpp"
 #include "../include/PPU.hpp"
 #include "../include/RegisterAddresses.hpp"
+#include <array>
 #include <cstdint>
-#include <functional>
 #include <iostream>
 #include <optional>
 
-#ifdef LOGGING
-#include <iomanip>
-#include <fstream>
-#endif
-
 CPU::CPU(APU& apu, Controller& controller, PPU& ppu) :
     apu_(apu),
+    cartridge_(nullptr),
     controller_(controller),
-    ppu_(ppu)
+    ppu_(ppu),
+    trace_(nullptr),
+    idleLoopSkipping_(true)
 {
     Initialize();
-    tickFunction_ = std::bind(&CPU::ResetVector, this);
 }
 
 void CPU::Clock()
 {
     oddCycle_ = !oddCycle_;
     ++totalCycles_;
+    syncedCycles_ = totalCycles_;
+    idleLoopClean_ = false;
 
     if (dmcStall_)
     {
@@ -63,7 +63,7 @@ void CPU::Clock()
     }
     else
     {
-        tickFunction_();
+        (this->*tickFunction_)();
     }
 }
 
@@ -95,8 +95,8 @@ void CPU::Reset()
     regData_ = 0x00;
     isStoreOp_ = false;
     branchCondition_ = false;
-    instruction_ = [](){};
-    tickFunction_ = std::bind(&CPU::ResetVector, this);
+    instruction_ = &CPU::NOP;
+    tickFunction_ = &CPU::ResetVector;
 }
 
 void CPU::LoadCartridge(Cartridge* cartridge)
@@ -111,11 +111,20 @@ void CPU::Initialize()
     cycle_ = 1;
     oddCycle_ = false;
 
-    // Logging
-    #ifdef LOGGING
-    log_.open("../Logs/log.log");
+    // Timing
     totalCycles_ = 0;
-    #endif
+    syncedCycles_ = 0;
+    eventCycle_ = 0;
+    stepEndCycle_ = 0;
+    operandPage_ = nullptr;
+
+    // Idle loop skipping
+    idleLoopClean_ = false;
+    idleLoopReadsStatus_ = false;
+    idleLoopHead_ = 0x0000;
+    idleLoopHeadCycle_ = 0;
+    idleLoopStatusLimit_ = 0;
+    idleLoopLength_ = 0;
 
     // APU DMC
     dmcStall_ = false;
@@ -124,7 +133,7 @@ void CPU::Initialize()
 
     // Registers
     Registers_.accumulator = 0x00;
-    Registers_.status = 0x24;
+    SetStatus(0x24);
     Registers_.stackPointer = 0xFD;
     Registers_.x = 0x00;
     Registers_.y = 0x00;
@@ -146,8 +155,8 @@ void CPU::Initialize()
     regData_ = 0x00;
     isStoreOp_ = false;
     branchCondition_ = false;
-    instruction_ = [](){};
-    tickFunction_ = [](){};
+    instruction_ = &CPU::NOP;
+    tickFunction_ = &CPU::ResetVector;
 }
 
 uint8_t CPU::Read(uint16_t addr)
@@ -156,7 +165,16 @@ uint8_t CPU::Read(uint16_t addr)
     {
         return RAM_[addr % 0x0800];
     }
-    else if (addr < 0x4000)
+
+    // PRG ROM and RAM mapped by the cartridge are read directly
+    uint8_t const* page = cartridge_->GetPrgReadPage(addr);
+
+    if (page != nullptr)
+    {
+        return page[addr % PRG_PAGE_SIZE];
+    }
+
+    if (addr < 0x4000)
     {
         return ppu_.ReadReg(addr);
     }
@@ -181,9 +199,19 @@ uint8_t CPU::Read(uint16_t addr)
 
 void CPU::Write(uint16_t addr, uint8_t data)
 {
+    idleLoopClean_ = false;
+
     if (addr < 0x2000)
     {
         RAM_[addr % 0x0800] = data;
+        return;
+    }
+
+    uint8_t* page = cartridge_->GetPrgWritePage(addr);
+
+    if (page != nullptr)
+    {
+        page[addr % PRG_PAGE_SIZE] = data;
     }
     else if (addr < 0x4000)
     {
@@ -220,63 +248,74 @@ uint8_t CPU::Pop()
 
 void CPU::Push(uint8_t data)
 {
+    idleLoopClean_ = false;
     RAM_[STACK_PAGE | Registers_.stackPointer] = data;
     --Registers_.stackPointer;
 }
 
 void CPU::SetNextOpCode()
 {
-    #ifdef LOGGING
-
-    uint16_t current_pc = Registers_.programCounter;
-    opCode_ = static_cast<OpCode>(ReadAndIncrementPC());
-    cycle_ = 0;
-    auto [scanline, dot] = ppu.GetState();
-
-    log_ << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << current_pc << "  " << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(opCode_) << "  ";
-    log_ << "A:" << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(Registers_.accumulator) << " X:" << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(Registers_.x) << " Y:";
-    log_ << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(Registers_.y) << " P:" << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(Registers_.status) << " SP:";
-    log_ << std::setfill('0') << std::setw(2) << static_cast<unsigned int>(Registers_.stackPointer) << " ";
-    log_ << "PPU:" << std::dec << std::setw(3) << std::setfill(' ') << (unsigned int)scanline << ",";
-    log_ << std::setw(3) << std::setfill(' ') << (unsigned int)dot << " ";
-    log_ << "CYC:" << std::dec << static_cast<unsigned int>(totalCycles_) << "\n";
-
-    if (ppu.NMI())
-    {
-        cycle_ = 1;
-        --Registers_.programCounter;
-        tickFunction_ = std::bind(&CPU::NMI, this);
-        tickFunction_();
-    }
-    else if (!IsInterruptDisable() && cartridge.IRQ())
-    {
-        cycle_ = 1;
-        --Registers_.programCounter;
-        tickFunction_ = std::bind(&CPU::IRQ, this);
-        tickFunction_();
-    }
-
-    #else
-
     if (ppu_.NMI())
     {
         cycle_ = 1;
-        tickFunction_ = std::bind(&CPU::NMI, this);
-        tickFunction_();
+        tickFunction_ = &CPU::NMI;
+        (this->*tickFunction_)();
     }
     else if (!IsInterruptDisable() && (apu_.IRQ() || cartridge_->IRQ()))
     {
         cycle_ = 1;
-        tickFunction_ = std::bind(&CPU::IRQ, this);
-        tickFunction_();
+        tickFunction_ = &CPU::IRQ;
+        (this->*tickFunction_)();
     }
     else
     {
         opCode_ = static_cast<OpCode>(ReadAndIncrementPC());
         cycle_ = 0;
+
+        if (trace_ != nullptr)
+        {
+            TraceInstruction();
+        }
     }
+}
+
+void CPU::SetTrace(CpuTrace* trace)
+{
+    trace_ = trace;
+}
+
+void CPU::TraceInstruction()
+{
+    // The PPU lags behind while stepping instructions, so catch it up to get its position on the fetch cycle.
+    CatchUp();
+    auto [scanline, dot] = ppu_.GetState();
 
-    #endif
+    TraceRecord record;
+    record.cycle = totalCycles_;
+    record.programCounter = Registers_.programCounter - 1;
+    record.scanline = scanline;
+    record.dot = dot;
+    record.opCode = static_cast<uint8_t>(opCode_);
+    record.accumulator = Registers_.accumulator;
+    record.x = Registers_.x;
+    record.y = Registers_.y;
+    record.status = GetStatus();
+    record.stackPointer = Registers_.stackPointer;
+    record.operands[0] = Peek(Registers_.programCounter);
+    record.operands[1] = Peek(Registers_.programCounter + 1);
+    trace_->Record(record);
+}
+
+uint8_t CPU::Peek(uint16_t addr)
+{
+    // Read memory without touching any registers
+    if (addr < 0x2000)
+    {
+        return RAM_[addr % 0x0800];
+    }
+
+    uint8_t const* page = cartridge_->GetPrgReadPage(addr);
+    return (page != nullptr) ? page[addr % PRG_PAGE_SIZE] : 0x00;
 }
 
 uint8_t CPU::ReadAndIncrementPC()
@@ -322,7 +361,7 @@ void CPU::IRQ()
             Push(Registers_.programCounter & 0xFF);
             break;
         case 5:
-            Push((Registers_.status | 0x20) & 0xEF);
+            Push((GetStatus() | 0x20) & 0xEF);
             break;
         case 6:
             iAddr_ = Read(BRK_VECTOR_LO);
@@ -356,7 +395,7 @@ void CPU::NMI()
             Push(Registers_.programCounter & 0xFF);
             break;
         case 5:
-            Push((Registers_.status | 0x20) & 0xEF);
+            Push((GetStatus() | 0x20) & 0xEF);
             break;
         case 6:
             iAddr_ = Read(NMI_VECTOR_LO);
@@ -370,38 +409,22 @@ void CPU::NMI()
     }
 }
 
-bool CPU::IsCarry() const
+uint8_t CPU::GetStatus() const
 {
-    return (Registers_.status & CARRY_FLAG) == CARRY_FLAG;
-}
-
-void CPU::SetCarry(bool val)
-{
-    if (val)
-    {
-        Registers_.status |= CARRY_FLAG;
-    }
-    else
-    {
-        Registers_.status &= ~CARRY_FLAG;
-    }
+    return (Registers_.status & ~(NEGATIVE_FLAG | OVERFLOW_FLAG | ZERO_FLAG | CARRY_FLAG)) |
+           (negativeResult_ & NEGATIVE_FLAG) |
+           ((overflowResult_ & MSB) >> 1) |
+           ((zeroResult_ == 0x00) ? ZERO_FLAG : 0x00) |
+           (carry_ ? CARRY_FLAG : 0x00);
 }
 
-bool CPU::IsZero() const
+void CPU::SetStatus(uint8_t status)
 {
-    return (Registers_.status & ZERO_FLAG) == ZERO_FLAG;
-}
-
-void CPU::SetZero(bool val)
-{
-    if (val)
-    {
-        Registers_.status |= ZERO_FLAG;
-    }
-    else
-    {
-        Registers_.status &= ~ZERO_FLAG;
-    }
+    Registers_.status = status;
+    negativeResult_ = status & NEGATIVE_FLAG;
+    overflowResult_ = (status & OVERFLOW_FLAG) << 1;
+    zeroResult_ = (status & ZERO_FLAG) ^ ZERO_FLAG;
+    carry_ = (status & CARRY_FLAG) == CARRY_FLAG;
 }
 
 bool CPU::IsInterruptDisable() const
@@ -438,40 +461,6 @@ void CPU::SetDecimal(bool val)
     }
 }
 
-bool CPU::IsOverflow() const
-{
-    return (Registers_.status & OVERFLOW_FLAG) == OVERFLOW_FLAG;
-}
-
-void CPU::SetOverflow(bool val)
-{
-    if (val)
-    {
-        Registers_.status |= OVERFLOW_FLAG;
-    }
-    else
-    {
-        Registers_.status &= ~OVERFLOW_FLAG;
-    }
-}
-
-bool CPU::IsNegative() const
-{
-    return (Registers_.status & NEGATIVE_FLAG) == NEGATIVE_FLAG;
-}
-
-void CPU::SetNegative(bool val)
-{
-    if (val)
-    {
-        Registers_.status |= NEGATIVE_FLAG;
-    }
-    else
-    {
-        Registers_.status &= ~NEGATIVE_FLAG;
-    }
-}
-
 void CPU::InitiateOamDmaTransfer(uint8_t sourcePage)
 {
     isOamDmaTransfer_ = true;
@@ -505,694 +494,267 @@ void CPU::ExecuteOamDmaTransfer()
     }
 }
 
+constexpr std::array<CPU::InstructionEntry, 256> CPU::CreateInstructionTable()
+{
+    std::array<InstructionEntry, 256> table{};
+
+    table[static_cast<uint8_t>(OpCode::Immediate_ADC)] = {&CPU::Immediate, &CPU::ADC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_ADC)] = {&CPU::ZeroPage, &CPU::ADC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_ADC)] = {&CPU::ZeroPageIndexed, &CPU::ADC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_ADC)] = {&CPU::Absolute, &CPU::ADC};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_ADC)] = {&CPU::AbsoluteIndexed, &CPU::ADC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_ADC)] = {&CPU::AbsoluteIndexed, &CPU::ADC, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_ADC)] = {&CPU::IndirectX, &CPU::ADC};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_ADC)] = {&CPU::IndirectY, &CPU::ADC};
+    table[static_cast<uint8_t>(OpCode::Immediate_AND)] = {&CPU::Immediate, &CPU::AND};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_AND)] = {&CPU::ZeroPage, &CPU::AND};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_AND)] = {&CPU::ZeroPageIndexed, &CPU::AND, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_AND)] = {&CPU::Absolute, &CPU::AND};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_AND)] = {&CPU::AbsoluteIndexed, &CPU::AND, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_AND)] = {&CPU::AbsoluteIndexed, &CPU::AND, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_AND)] = {&CPU::IndirectX, &CPU::AND};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_AND)] = {&CPU::IndirectY, &CPU::AND};
+    table[static_cast<uint8_t>(OpCode::Accumulator_ASL)] = {&CPU::Accumulator, &CPU::ASL};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_ASL)] = {&CPU::ZeroPageRMW, &CPU::ASL};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_ASL)] = {&CPU::ZeroPageIndexedRMW, &CPU::ASL, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_ASL)] = {&CPU::AbsoluteRWM, &CPU::ASL};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_ASL)] = {&CPU::AbsoluteIndexedRMW, &CPU::ASL, Register::X};
+    table[static_cast<uint8_t>(OpCode::Relative_BCC)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, CARRY_FLAG, false};
+    table[static_cast<uint8_t>(OpCode::Relative_BCS)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, CARRY_FLAG, true};
+    table[static_cast<uint8_t>(OpCode::Relative_BEQ)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, ZERO_FLAG, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_BIT)] = {&CPU::ZeroPage, &CPU::BIT};
+    table[static_cast<uint8_t>(OpCode::Absolute_BIT)] = {&CPU::Absolute, &CPU::BIT};
+    table[static_cast<uint8_t>(OpCode::Relative_BMI)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, NEGATIVE_FLAG, true};
+    table[static_cast<uint8_t>(OpCode::Relative_BNE)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, ZERO_FLAG, false};
+    table[static_cast<uint8_t>(OpCode::Relative_BPL)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, NEGATIVE_FLAG, false};
+    table[static_cast<uint8_t>(OpCode::Implied_BRK)] = {&CPU::BRK, nullptr};
+    table[static_cast<uint8_t>(OpCode::Relative_BVC)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, OVERFLOW_FLAG, false};
+    table[static_cast<uint8_t>(OpCode::Relative_BVS)] = {&CPU::Relative, nullptr, Register::NONE, Register::NONE, false, OVERFLOW_FLAG, true};
+    table[static_cast<uint8_t>(OpCode::Implied_CLC)] = {&CPU::Implied, &CPU::CLC};
+    table[static_cast<uint8_t>(OpCode::Implied_CLD)] = {&CPU::Implied, &CPU::CLD};
+    table[static_cast<uint8_t>(OpCode::Implied_CLI)] = {&CPU::Implied, &CPU::CLI};
+    table[static_cast<uint8_t>(OpCode::Implied_CLV)] = {&CPU::Implied, &CPU::CLV};
+    table[static_cast<uint8_t>(OpCode::Immediate_CMP)] = {&CPU::Immediate, &CPU::CMP, Register::NONE, Register::A};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_CMP)] = {&CPU::ZeroPage, &CPU::CMP, Register::NONE, Register::A};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_CMP)] = {&CPU::ZeroPageIndexed, &CPU::CMP, Register::X, Register::A};
+    table[static_cast<uint8_t>(OpCode::Absolute_CMP)] = {&CPU::Absolute, &CPU::CMP, Register::NONE, Register::A};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_CMP)] = {&CPU::AbsoluteIndexed, &CPU::CMP, Register::X, Register::A};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_CMP)] = {&CPU::AbsoluteIndexed, &CPU::CMP, Register::Y, Register::A};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_CMP)] = {&CPU::IndirectX, &CPU::CMP, Register::NONE, Register::A};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_CMP)] = {&CPU::IndirectY, &CPU::CMP, Register::NONE, Register::A};
+    table[static_cast<uint8_t>(OpCode::Immediate_CPX)] = {&CPU::Immediate, &CPU::CMP, Register::NONE, Register::X};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_CPX)] = {&CPU::ZeroPage, &CPU::CMP, Register::NONE, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_CPX)] = {&CPU::Absolute, &CPU::CMP, Register::NONE, Register::X};
+    table[static_cast<uint8_t>(OpCode::Immediate_CPY)] = {&CPU::Immediate, &CPU::CMP, Register::NONE, Register::Y};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_CPY)] = {&CPU::ZeroPage, &CPU::CMP, Register::NONE, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Absolute_CPY)] = {&CPU::Absolute, &CPU::CMP, Register::NONE, Register::Y};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_DEC)] = {&CPU::ZeroPageRMW, &CPU::DEC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_DEC)] = {&CPU::ZeroPageIndexedRMW, &CPU::DEC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_DEC)] = {&CPU::AbsoluteRWM, &CPU::DEC};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_DEC)] = {&CPU::AbsoluteIndexedRMW, &CPU::DEC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Implied_DEX)] = {&CPU::Implied, &CPU::DEX};
+    table[static_cast<uint8_t>(OpCode::Implied_DEY)] = {&CPU::Implied, &CPU::DEY};
+    table[static_cast<uint8_t>(OpCode::Immediate_EOR)] = {&CPU::Immediate, &CPU::EOR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_EOR)] = {&CPU::ZeroPage, &CPU::EOR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_EOR)] = {&CPU::ZeroPageIndexed, &CPU::EOR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_EOR)] = {&CPU::Absolute, &CPU::EOR};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_EOR)] = {&CPU::AbsoluteIndexed, &CPU::EOR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_EOR)] = {&CPU::AbsoluteIndexed, &CPU::EOR, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_EOR)] = {&CPU::IndirectX, &CPU::EOR};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_EOR)] = {&CPU::IndirectY, &CPU::EOR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_INC)] = {&CPU::ZeroPageRMW, &CPU::INC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_INC)] = {&CPU::ZeroPageIndexedRMW, &CPU::INC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_INC)] = {&CPU::AbsoluteRWM, &CPU::INC};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_INC)] = {&CPU::AbsoluteIndexedRMW, &CPU::INC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Implied_INX)] = {&CPU::Implied, &CPU::INX};
+    table[static_cast<uint8_t>(OpCode::Implied_INY)] = {&CPU::Implied, &CPU::INY};
+    table[static_cast<uint8_t>(OpCode::Absolute_JMP)] = {&CPU::AbsoluteJMP, nullptr};
+    table[static_cast<uint8_t>(OpCode::Indirect_JMP)] = {&CPU::IndirectJMP, nullptr};
+    table[static_cast<uint8_t>(OpCode::Absolute_JSR)] = {&CPU::JSR, nullptr};
+    table[static_cast<uint8_t>(OpCode::Immediate_LDA)] = {&CPU::Immediate, &CPU::LDA};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_LDA)] = {&CPU::ZeroPage, &CPU::LDA};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_LDA)] = {&CPU::ZeroPageIndexed, &CPU::LDA, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_LDA)] = {&CPU::Absolute, &CPU::LDA};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_LDA)] = {&CPU::AbsoluteIndexed, &CPU::LDA, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_LDA)] = {&CPU::AbsoluteIndexed, &CPU::LDA, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_LDA)] = {&CPU::IndirectX, &CPU::LDA};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_LDA)] = {&CPU::IndirectY, &CPU::LDA};
+    table[static_cast<uint8_t>(OpCode::Immediate_LDX)] = {&CPU::Immediate, &CPU::LDX};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_LDX)] = {&CPU::ZeroPage, &CPU::LDX};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_Y_LDX)] = {&CPU::ZeroPageIndexed, &CPU::LDX, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Absolute_LDX)] = {&CPU::Absolute, &CPU::LDX};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_LDX)] = {&CPU::AbsoluteIndexed, &CPU::LDX, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Immediate_LDY)] = {&CPU::Immediate, &CPU::LDY};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_LDY)] = {&CPU::ZeroPage, &CPU::LDY};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_LDY)] = {&CPU::ZeroPageIndexed, &CPU::LDY, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_LDY)] = {&CPU::Absolute, &CPU::LDY};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_LDY)] = {&CPU::AbsoluteIndexed, &CPU::LDY, Register::X};
+    table[static_cast<uint8_t>(OpCode::Accumulator_LSR)] = {&CPU::Accumulator, &CPU::LSR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_LSR)] = {&CPU::ZeroPageRMW, &CPU::LSR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_LSR)] = {&CPU::ZeroPageIndexedRMW, &CPU::LSR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_LSR)] = {&CPU::AbsoluteRWM, &CPU::LSR};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_LSR)] = {&CPU::AbsoluteIndexedRMW, &CPU::LSR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Implied_NOP)] = {&CPU::Implied, &CPU::NOP};
+    table[static_cast<uint8_t>(OpCode::Immediate_ORA)] = {&CPU::Immediate, &CPU::ORA};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_ORA)] = {&CPU::ZeroPage, &CPU::ORA};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_ORA)] = {&CPU::ZeroPageIndexed, &CPU::ORA, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_ORA)] = {&CPU::Absolute, &CPU::ORA};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_ORA)] = {&CPU::AbsoluteIndexed, &CPU::ORA, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_ORA)] = {&CPU::AbsoluteIndexed, &CPU::ORA, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_ORA)] = {&CPU::IndirectX, &CPU::ORA};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_ORA)] = {&CPU::IndirectY, &CPU::ORA};
+    table[static_cast<uint8_t>(OpCode::Implied_PHA)] = {&CPU::PHA, nullptr};
+    table[static_cast<uint8_t>(OpCode::Implied_PHP)] = {&CPU::PHP, nullptr};
+    table[static_cast<uint8_t>(OpCode::Implied_PLA)] = {&CPU::PLA, nullptr};
+    table[static_cast<uint8_t>(OpCode::Implied_PLP)] = {&CPU::PLP, nullptr};
+    table[static_cast<uint8_t>(OpCode::Accumulator_ROL)] = {&CPU::Accumulator, &CPU::ROL};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_ROL)] = {&CPU::ZeroPageRMW, &CPU::ROL};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_ROL)] = {&CPU::ZeroPageIndexedRMW, &CPU::ROL, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_ROL)] = {&CPU::AbsoluteRWM, &CPU::ROL};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_ROL)] = {&CPU::AbsoluteIndexedRMW, &CPU::ROL, Register::X};
+    table[static_cast<uint8_t>(OpCode::Accumulator_ROR)] = {&CPU::Accumulator, &CPU::ROR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_ROR)] = {&CPU::ZeroPageRMW, &CPU::ROR};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_ROR)] = {&CPU::ZeroPageIndexedRMW, &CPU::ROR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_ROR)] = {&CPU::AbsoluteRWM, &CPU::ROR};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_ROR)] = {&CPU::AbsoluteIndexedRMW, &CPU::ROR, Register::X};
+    table[static_cast<uint8_t>(OpCode::Implied_RTI)] = {&CPU::RTI, nullptr};
+    table[static_cast<uint8_t>(OpCode::Implied_RTS)] = {&CPU::RTS, nullptr};
+    table[static_cast<uint8_t>(OpCode::Immediate_SBC)] = {&CPU::Immediate, &CPU::SBC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_SBC)] = {&CPU::ZeroPage, &CPU::SBC};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_SBC)] = {&CPU::ZeroPageIndexed, &CPU::SBC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_SBC)] = {&CPU::Absolute, &CPU::SBC};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_SBC)] = {&CPU::AbsoluteIndexed, &CPU::SBC, Register::X};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_SBC)] = {&CPU::AbsoluteIndexed, &CPU::SBC, Register::Y};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_SBC)] = {&CPU::IndirectX, &CPU::SBC};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_SBC)] = {&CPU::IndirectY, &CPU::SBC};
+    table[static_cast<uint8_t>(OpCode::Implied_SEC)] = {&CPU::Implied, &CPU::SEC};
+    table[static_cast<uint8_t>(OpCode::Implied_SED)] = {&CPU::Implied, &CPU::SED};
+    table[static_cast<uint8_t>(OpCode::Implied_SEI)] = {&CPU::Implied, &CPU::SEI};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_STA)] = {&CPU::ZeroPage, &CPU::NOP, Register::NONE, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_STA)] = {&CPU::ZeroPageIndexed, &CPU::NOP, Register::X, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::Absolute_STA)] = {&CPU::Absolute, &CPU::NOP, Register::NONE, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::Absolute_X_STA)] = {&CPU::AbsoluteIndexed, &CPU::NOP, Register::X, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::Absolute_Y_STA)] = {&CPU::AbsoluteIndexed, &CPU::NOP, Register::Y, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::Indirect_X_STA)] = {&CPU::IndirectX, &CPU::NOP, Register::NONE, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::Indirect_Y_STA)] = {&CPU::IndirectY, &CPU::NOP, Register::NONE, Register::A, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_STX)] = {&CPU::ZeroPage, &CPU::NOP, Register::NONE, Register::X, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_Y_STX)] = {&CPU::ZeroPageIndexed, &CPU::NOP, Register::Y, Register::X, true};
+    table[static_cast<uint8_t>(OpCode::Absolute_STX)] = {&CPU::Absolute, &CPU::NOP, Register::NONE, Register::X, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_STY)] = {&CPU::ZeroPage, &CPU::NOP, Register::NONE, Register::Y, true};
+    table[static_cast<uint8_t>(OpCode::ZeroPage_X_STY)] = {&CPU::ZeroPageIndexed, &CPU::NOP, Register::X, Register::Y, true};
+    table[static_cast<uint8_t>(OpCode::Absolute_STY)] = {&CPU::Absolute, &CPU::NOP, Register::NONE, Register::Y, true};
+    table[static_cast<uint8_t>(OpCode::Implied_TAX)] = {&CPU::Implied, &CPU::TAX};
+    table[static_cast<uint8_t>(OpCode::Implied_TAY)] = {&CPU::Implied, &CPU::TAY};
+    table[static_cast<uint8_t>(OpCode::Implied_TSX)] = {&CPU::Implied, &CPU::TSX};
+    table[static_cast<uint8_t>(OpCode::Implied_TXA)] = {&CPU::Implied, &CPU::TXA};
+    table[static_cast<uint8_t>(OpCode::Implied_TXS)] = {&CPU::Implied, &CPU::TXS};
+    table[static_cast<uint8_t>(OpCode::Implied_TYA)] = {&CPU::Implied, &CPU::TYA};
+
+    struct AddressingMode
+    {
+        void (CPU::*tickFunction)();
+        void (CPU::*stepFunction)();
+        uint8_t maxCycles;
+    };
+
+    constexpr AddressingMode modes[] = {
+        {&CPU::Immediate, &CPU::StepImmediate, 2},
+        {&CPU::Absolute, &CPU::StepAbsolute, 4},
+        {&CPU::ZeroPage, &CPU::StepZeroPage, 3},
+        {&CPU::Implied, &CPU::StepImplied, 2},
+        {&CPU::AbsoluteIndexed, &CPU::StepAbsoluteIndexed, 5},
+        {&CPU::ZeroPageIndexed, &CPU::StepZeroPageIndexed, 4},
+        {&CPU::IndirectX, &CPU::StepIndirectX, 6},
+        {&CPU::IndirectY, &CPU::StepIndirectY, 6},
+        {&CPU::Relative, &CPU::StepRelative, 4},
+        {&CPU::Accumulator, &CPU::StepAccumulator, 2},
+        {&CPU::ZeroPageRMW, &CPU::StepZeroPageRMW, 5},
+        {&CPU::ZeroPageIndexedRMW, &CPU::StepZeroPageIndexedRMW, 6},
+        {&CPU::AbsoluteRWM, &CPU::StepAbsoluteRWM, 6},
+        {&CPU::AbsoluteIndexedRMW, &CPU::StepAbsoluteIndexedRMW, 7},
+        {&CPU::BRK, &CPU::StepBRK, 7},
+        {&CPU::JSR, &CPU::StepJSR, 6},
+        {&CPU::PHA, &CPU::StepPHA, 3},
+        {&CPU::PHP, &CPU::StepPHP, 3},
+        {&CPU::PLA, &CPU::StepPLA, 4},
+        {&CPU::PLP, &CPU::StepPLP, 4},
+        {&CPU::RTI, &CPU::StepRTI, 6},
+        {&CPU::RTS, &CPU::StepRTS, 6},
+        {&CPU::AbsoluteJMP, &CPU::StepAbsoluteJMP, 3},
+        {&CPU::IndirectJMP, &CPU::StepIndirectJMP, 5},
+    };
+
+    for (InstructionEntry& entry : table)
+    {
+        for (AddressingMode const& mode : modes)
+        {
+            if (entry.tickFunction == mode.tickFunction)
+            {
+                entry.stepFunction = mode.stepFunction;
+                entry.maxCycles = mode.maxCycles;
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr std::array<CPU::InstructionEntry, 256> CPU::INSTRUCTION_TABLE = CPU::CreateInstructionTable();
+
+uint8_t CPU::GetRegister(Register reg) const
+{
+    switch (reg)
+    {
+        case Register::A:
+            return Registers_.accumulator;
+        case Register::X:
+            return Registers_.x;
+        case Register::Y:
+            return Registers_.y;
+        default:
+            return 0x00;
+    }
+}
+
+void CPU::LoadInstruction(InstructionEntry const& entry)
+{
+    isStoreOp_ = entry.isStoreOp;
+
+    if (entry.index != Register::NONE)
+    {
+        instructionIndex_ = GetRegister(entry.index);
+    }
+
+    if (entry.regData != Register::NONE)
+    {
+        regData_ = GetRegister(entry.regData);
+    }
+
+    if (entry.branchFlag != 0x00)
+    {
+        branchCondition_ = ((GetStatus() & entry.branchFlag) == entry.branchFlag) == entry.branchIfSet;
+    }
+
+    instruction_ = entry.instruction;
+    tickFunction_ = entry.tickFunction;
+}
+
 void CPU::DecodeOpCode()
 {
-    isStoreOp_ = false;
+    InstructionEntry const& entry = INSTRUCTION_TABLE[static_cast<uint8_t>(opCode_)];
 
-    switch (opCode_)
+    if (entry.tickFunction == nullptr)
     {
-        case OpCode::Immediate_ADC:
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_ADC:
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_ADC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_ADC:
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_ADC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_ADC:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_ADC:
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_ADC:
-            instruction_ = std::bind(&CPU::ADC, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Immediate_AND:
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_AND:
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_AND:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_AND:
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_AND:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_AND:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_AND:
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_AND:
-            instruction_ = std::bind(&CPU::AND, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Accumulator_ASL:
-            instruction_ = std::bind(&CPU::ASL, this);
-            tickFunction_ = std::bind(&CPU::Accumulator, this);
-            break;
-        case OpCode::ZeroPage_ASL:
-            instruction_ = std::bind(&CPU::ASL, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_ASL:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ASL, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_ASL:
-            instruction_ = std::bind(&CPU::ASL, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_ASL:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ASL, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Relative_BCC:
-            branchCondition_ = !IsCarry();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Relative_BCS:
-            branchCondition_ = IsCarry();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Relative_BEQ:
-            branchCondition_ = IsZero();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::ZeroPage_BIT:
-            instruction_ = std::bind(&CPU::BIT, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::Absolute_BIT:
-            instruction_ = std::bind(&CPU::BIT, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Relative_BMI:
-            branchCondition_ = IsNegative();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Relative_BNE:
-            branchCondition_ = !IsZero();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Relative_BPL:
-            branchCondition_ = !IsNegative();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Implied_BRK:
-            tickFunction_ = std::bind(&CPU::BRK, this);
-            break;
-        case OpCode::Relative_BVC:
-            branchCondition_ = !IsOverflow();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Relative_BVS:
-            branchCondition_ = IsOverflow();
-            tickFunction_ = std::bind(&CPU::Relative, this);
-            break;
-        case OpCode::Implied_CLC:
-            instruction_ = std::bind(&CPU::SetCarry, this, false);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_CLD:
-            instruction_ = std::bind(&CPU::SetDecimal, this, false);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_CLI:
-            instruction_ = std::bind(&CPU::SetInterruptDisable, this, false);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_CLV:
-            instruction_ = std::bind(&CPU::SetOverflow, this, false);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Immediate_CMP:
-            regData_ = Registers_.accumulator;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_CMP:
-            regData_ = Registers_.accumulator;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_CMP:
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_CMP:
-            regData_ = Registers_.accumulator;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_CMP:
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_CMP:
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_CMP:
-            regData_ = Registers_.accumulator;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_CMP:
-            regData_ = Registers_.accumulator;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Immediate_CPX:
-            regData_ = Registers_.x;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_CPX:
-            regData_ = Registers_.x;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::Absolute_CPX:
-            regData_ = Registers_.x;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Immediate_CPY:
-            regData_ = Registers_.y;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_CPY:
-            regData_ = Registers_.y;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::Absolute_CPY:
-            regData_ = Registers_.y;
-            instruction_ = std::bind(&CPU::CMP, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::ZeroPage_DEC:
-            instruction_ = std::bind(&CPU::DEC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_DEC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::DEC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_DEC:
-            instruction_ = std::bind(&CPU::DEC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_DEC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::DEC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Implied_DEX:
-            instruction_ = std::bind(&CPU::DEX, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_DEY:
-            instruction_ = std::bind(&CPU::DEY, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Immediate_EOR:
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_EOR:
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_EOR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_EOR:
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_EOR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_EOR:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_EOR:
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_EOR:
-            instruction_ = std::bind(&CPU::EOR, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::ZeroPage_INC:
-            instruction_ = std::bind(&CPU::INC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_INC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::INC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_INC:
-            instruction_ = std::bind(&CPU::INC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_INC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::INC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Implied_INX:
-            instruction_ = std::bind(&CPU::INX, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_INY:
-            instruction_ = std::bind(&CPU::INY, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Absolute_JMP:
-            tickFunction_ = std::bind(&CPU::AbsoluteJMP, this);
-            break;
-        case OpCode::Indirect_JMP:
-            tickFunction_ = std::bind(&CPU::IndirectJMP, this);
-            break;
-        case OpCode::Absolute_JSR:
-            tickFunction_ = std::bind(&CPU::JSR, this);
-            break;
-        case OpCode::Immediate_LDA:
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_LDA:
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_LDA:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_LDA:
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_LDA:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_LDA:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_LDA:
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_LDA:
-            instruction_ = std::bind(&CPU::LDA, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Immediate_LDX:
-            instruction_ = std::bind(&CPU::LDX, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_LDX:
-            instruction_ = std::bind(&CPU::LDX, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_Y_LDX:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::LDX, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_LDX:
-            instruction_ = std::bind(&CPU::LDX, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_Y_LDX:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::LDX, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Immediate_LDY:
-            instruction_ = std::bind(&CPU::LDY, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_LDY:
-            instruction_ = std::bind(&CPU::LDY, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_LDY:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LDY, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_LDY:
-            instruction_ = std::bind(&CPU::LDY, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_LDY:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LDY, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Accumulator_LSR:
-            instruction_ = std::bind(&CPU::LSR, this);
-            tickFunction_ = std::bind(&CPU::Accumulator, this);
-            break;
-        case OpCode::ZeroPage_LSR:
-            instruction_ = std::bind(&CPU::LSR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_LSR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LSR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_LSR:
-            instruction_ = std::bind(&CPU::LSR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_LSR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::LSR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Implied_NOP:
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Immediate_ORA:
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_ORA:
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_ORA:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_ORA:
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_ORA:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_ORA:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_ORA:
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_ORA:
-            instruction_ = std::bind(&CPU::ORA, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Implied_PHA:
-            tickFunction_ = std::bind(&CPU::PHA, this);
-            break;
-        case OpCode::Implied_PHP:
-            tickFunction_ = std::bind(&CPU::PHP, this);
-            break;
-        case OpCode::Implied_PLA:
-            tickFunction_ = std::bind(&CPU::PLA, this);
-            break;
-        case OpCode::Implied_PLP:
-            tickFunction_ = std::bind(&CPU::PLP, this);
-            break;
-        case OpCode::Accumulator_ROL:
-            instruction_ = std::bind(&CPU::ROL, this);
-            tickFunction_ = std::bind(&CPU::Accumulator, this);
-            break;
-        case OpCode::ZeroPage_ROL:
-            instruction_ = std::bind(&CPU::ROL, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_ROL:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ROL, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_ROL:
-            instruction_ = std::bind(&CPU::ROL, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_ROL:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ROL, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Accumulator_ROR:
-            instruction_ = std::bind(&CPU::ROR, this);
-            tickFunction_ = std::bind(&CPU::Accumulator, this);
-            break;
-        case OpCode::ZeroPage_ROR:
-            instruction_ = std::bind(&CPU::ROR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageRMW, this);
-            break;
-        case OpCode::ZeroPage_X_ROR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ROR, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexedRMW, this);
-            break;
-        case OpCode::Absolute_ROR:
-            instruction_ = std::bind(&CPU::ROR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteRWM, this);
-            break;
-        case OpCode::Absolute_X_ROR:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::ROR, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexedRMW, this);
-            break;
-        case OpCode::Implied_RTI:
-            tickFunction_ = std::bind(&CPU::RTI, this);
-            break;
-        case OpCode::Implied_RTS:
-            tickFunction_ = std::bind(&CPU::RTS, this);
-            break;
-        case OpCode::Immediate_SBC:
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::Immediate, this);
-            break;
-        case OpCode::ZeroPage_SBC:
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_SBC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_SBC:
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_SBC:
-            instructionIndex_ = Registers_.x;
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_SBC:
-            instructionIndex_ = Registers_.y;
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_SBC:
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_SBC:
-            instruction_ = std::bind(&CPU::SBC, this);
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::Implied_SEC:
-            instruction_ = std::bind(&CPU::SetCarry, this, true);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_SED:
-            instruction_ = std::bind(&CPU::SetDecimal, this, true);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_SEI:
-            instruction_ = std::bind(&CPU::SetInterruptDisable, this, true);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::ZeroPage_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.x;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Absolute_X_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.x;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Absolute_Y_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instructionIndex_ = Registers_.y;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::AbsoluteIndexed, this);
-            break;
-        case OpCode::Indirect_X_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::IndirectX, this);
-            break;
-        case OpCode::Indirect_Y_STA:
-            isStoreOp_ = true;
-            regData_ = Registers_.accumulator;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::IndirectY, this);
-            break;
-        case OpCode::ZeroPage_STX:
-            isStoreOp_ = true;
-            regData_ = Registers_.x;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_Y_STX:
-            isStoreOp_ = true;
-            regData_ = Registers_.x;
-            instructionIndex_ = Registers_.y;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_STX:
-            isStoreOp_ = true;
-            regData_ = Registers_.x;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::ZeroPage_STY:
-            isStoreOp_ = true;
-            regData_ = Registers_.y;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPage, this);
-            break;
-        case OpCode::ZeroPage_X_STY:
-            isStoreOp_ = true;
-            regData_ = Registers_.y;
-            instructionIndex_ = Registers_.x;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::ZeroPageIndexed, this);
-            break;
-        case OpCode::Absolute_STY:
-            isStoreOp_ = true;
-            regData_ = Registers_.y;
-            instruction_ = [](){};
-            tickFunction_ = std::bind(&CPU::Absolute, this);
-            break;
-        case OpCode::Implied_TAX:
-            instruction_ = std::bind(&CPU::TAX, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_TAY:
-            instruction_ = std::bind(&CPU::TAY, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_TSX:
-            instruction_ = std::bind(&CPU::TSX, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_TXA:
-            instruction_ = std::bind(&CPU::TXA, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_TXS:
-            instruction_ = std::bind(&CPU::TXS, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        case OpCode::Implied_TYA:
-            instruction_ = std::bind(&CPU::TYA, this);
-            tickFunction_ = std::bind(&CPU::Implied, this);
-            break;
-        default:
-            std::cout << "INVALID OPCODE " << std::hex << (unsigned int)opCode_ << std::endl;
-            SetNextOpCode();
+        isStoreOp_ = false;
+        std::cout << "INVALID OPCODE " << std::hex << (unsigned int)opCode_ << std::endl;
+        SetNextOpCode();
+    }
+    else
+    {
+        LoadInstruction(entry);
     }
 
-    tickFunction_();
+    (this->*tickFunction_)();
 }
 
 bool CPU::Serializable()
@@ -1205,7 +767,11 @@ void CPU::Serialize(std::ofstream& saveState)
     uint16_t byteExpander = static_cast<uint16_t>(opCode_);
     saveState.write((char*)&byteExpander, sizeof(opCode_));
     saveState.write((char*)&oddCycle_, sizeof(oddCycle_));
-    saveState.write((char*)&Registers_, sizeof(Registers_));
+
+    // Save states hold P with the lazily evaluated flags packed back in
+    auto registers = Registers_;
+    registers.status = GetStatus();
+    saveState.write((char*)&registers, sizeof(registers));
     saveState.write((char*)RAM_.data(), 0x0800);
 }
 
@@ -1215,10 +781,13 @@ void CPU::Deserialize(std::ifstream& saveState)
     saveState.read((char*)&oddCycle_, sizeof(oddCycle_));
     saveState.read((char*)&Registers_, sizeof(Registers_));
     saveState.read((char*)RAM_.data(), 0x0800);
+    SetStatus(Registers_.status);
 
     cycle_ = 0;
     isOamDmaTransfer_ = false;
     isStoreOp_ = false;
     branchCondition_ = false;
     dmcStall_ = false;
+    idleLoopClean_ = false;
+    idleLoopLength_ = 0;
 }
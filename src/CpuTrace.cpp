@@ -0,0 +1,73 @@
+#include "../include/CpuTrace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+CpuTrace::CpuTrace(std::filesystem::path const tracePath) :
+    ring_(std::make_unique<TraceRecord[]>(TRACE_RING_SIZE)),
+    head_(0),
+    cachedTail_(0),
+    tail_(0),
+    traceFile_(tracePath, std::ios::binary),
+    running_(true)
+{
+    if (traceFile_.is_open())
+    {
+        traceFile_.write(TRACE_MAGIC.data(), TRACE_MAGIC.size());
+        writerThread_ = std::thread(&CpuTrace::WriterThread, this);
+    }
+}
+
+CpuTrace::~CpuTrace()
+{
+    running_ = false;
+
+    if (writerThread_.joinable())
+    {
+        writerThread_.join();
+    }
+
+    // Anything recorded after the writer thread's last pass
+    Drain();
+}
+
+void CpuTrace::WriterThread()
+{
+    while (running_)
+    {
+        if (Drain() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+size_t CpuTrace::Drain()
+{
+    // Write everything between tail_ and head_, split in two if it wraps around the end of the ring.
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t head = head_.load(std::memory_order_acquire);
+    size_t count = head - tail;
+
+    if ((count == 0) || !traceFile_.is_open())
+    {
+        return 0;
+    }
+
+    size_t start = tail & TRACE_RING_MASK;
+    size_t firstChunk = std::min(count, TRACE_RING_SIZE - start);
+    traceFile_.write((char*)&ring_[start], firstChunk * sizeof(TraceRecord));
+
+    if (firstChunk < count)
+    {
+        traceFile_.write((char*)&ring_[0], (count - firstChunk) * sizeof(TraceRecord));
+    }
+
+    tail_.store(head, std::memory_order_release);
+    return count;
+}
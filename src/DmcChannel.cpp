@@ -1,7 +1,9 @@
 #include "../include/DmcChannel.hpp"
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <limits>
 #include <optional>
 
 DmcChannel::DmcChannel()
@@ -31,7 +33,7 @@ void DmcChannel::Reset()
     loop_ = false;
 }
 
-uint8_t DmcChannel::GetOutput()
+uint8_t DmcChannel::GetOutput() const
 {
     return outputLevel_;
 }
@@ -100,6 +102,44 @@ void DmcChannel::Clock()
     }
 }
 
+void DmcChannel::Run(int clocks)
+{
+    // Same as clocks calls to Clock()
+    if (clocks <= timer_)
+    {
+        timer_ -= clocks;
+        return;
+    }
+
+    if (!silence_ || sampleBufferLoaded_)
+    {
+        for (; clocks > 0; --clocks)
+        {
+            Clock();
+        }
+
+        return;
+    }
+
+    // With nothing to play, output clocks only shift out the empty register and count down its bits
+    clocks -= timer_ + 1;
+    int period = timerReload_ + 1;
+    int outputClocks = 1 + (clocks / period);
+    timer_ = timerReload_ - (clocks % period);
+    shiftReg_ = (outputClocks >= 8) ? 0 : (shiftReg_ >> outputClocks);
+    bitsRemaining_ = ((((std::max(bitsRemaining_, 1) - 1 - outputClocks) % 8) + 8) % 8) + 1;
+}
+
+int DmcChannel::ClocksUntilOutputChange() const
+{
+    if (silence_ && !sampleBufferLoaded_)
+    {
+        return std::numeric_limits<int>::max();
+    }
+
+    return timer_ + 1;
+}
+
 void DmcChannel::RegisterUpdate(uint16_t addr, uint8_t data)
 {
     int reg = addr & 0x03;
@@ -133,6 +173,22 @@ std::optional<uint16_t> DmcChannel::RequestSample()
     return {};
 }
 
+int DmcChannel::CyclesUntilRequest()
+{
+    if (bytesRemaining_ == 0)
+    {
+        return std::numeric_limits<int>::max();
+    }
+    else if (!sampleBufferLoaded_)
+    {
+        return 0;
+    }
+
+    // The sample buffer is emptied by the output clock that finishes the current byte.
+    int outputClocks = std::max(bitsRemaining_, 1);
+    return timer_ + 1 + ((outputClocks - 1) * (timerReload_ + 1));
+}
+
 void DmcChannel::SetSample(uint8_t sample)
 {
     sampleBuffer_ = sample;
@@ -0,0 +1,157 @@
+#include "../include/FrameConverter.hpp"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FRAME_CONVERTER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace
+{
+uint32_t PackPixel(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3)
+{
+    // Packed so the bytes land in memory in the order given, whatever the host byte order is
+    std::array<uint8_t, 4> bytes = {b0, b1, b2, b3};
+    uint32_t pixel;
+    std::memcpy(&pixel, bytes.data(), sizeof(pixel));
+    return pixel;
+}
+
+#ifdef FRAME_CONVERTER_AVX2
+__attribute__((target("avx2")))
+void ConvertRowAvx2(uint16_t const* src, uint8_t* dst, uint32_t const* lut, size_t bytesPerPixel)
+{
+    // Gather 8 pixels at a time. RGB24 drops every fourth byte within each 128 bit lane and writes 12 bytes per lane,
+    // each 16 byte store spilling 4 bytes that the next store overwrites. The last 8 pixels are left to the scalar
+    // loop so nothing is written past the end of the row.
+    __m256i const indexMask = _mm256_set1_epi32(PIXEL_LUT_SIZE - 1);
+    __m256i const rgbShuffle = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+                                                0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    size_t x = 0;
+
+    if (bytesPerPixel == 4)
+    {
+        for (; x + 8 <= FRAME_WIDTH; x += 8)
+        {
+            __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i const*)(src + x)));
+            index = _mm256_and_si256(index, indexMask);
+            __m256i color = _mm256_i32gather_epi32((int const*)lut, index, 4);
+            _mm256_storeu_si256((__m256i*)(dst + (x * 4)), color);
+        }
+    }
+    else
+    {
+        for (; x + 16 <= FRAME_WIDTH; x += 8)
+        {
+            __m256i index = _mm256_cvtepu16_epi32(_mm_loadu_si128((__m128i const*)(src + x)));
+            index = _mm256_and_si256(index, indexMask);
+            __m256i color = _mm256_shuffle_epi8(_mm256_i32gather_epi32((int const*)lut, index, 4), rgbShuffle);
+            _mm_storeu_si128((__m128i*)(dst + (x * 3)), _mm256_castsi256_si128(color));
+            _mm_storeu_si128((__m128i*)(dst + (x * 3) + 12), _mm256_extracti128_si256(color, 1));
+        }
+    }
+
+    for (; x < FRAME_WIDTH; ++x)
+    {
+        std::memcpy(dst + (x * bytesPerPixel), &lut[src[x] & (PIXEL_LUT_SIZE - 1)], bytesPerPixel);
+    }
+}
+#endif
+}
+
+FrameConverter::FrameConverter(std::ifstream& normalColors, std::ifstream& grayscaleColors) :
+    overscan_(false)
+{
+    // Palette files hold 8 emphasis levels of 64 RGB24 colors each, which matches the order of the pixel bits
+    constexpr size_t PALETTE_SIZE = (PIXEL_LUT_SIZE / 2) * 3;
+    std::array<uint8_t, PALETTE_SIZE * 2> palettes {};
+    normalColors.read((char*)palettes.data(), PALETTE_SIZE);
+    grayscaleColors.read((char*)palettes.data() + PALETTE_SIZE, PALETTE_SIZE);
+
+    for (size_t i = 0; i < PIXEL_LUT_SIZE; ++i)
+    {
+        uint8_t r = palettes[(i * 3)];
+        uint8_t g = palettes[(i * 3) + 1];
+        uint8_t b = palettes[(i * 3) + 2];
+        rgbaLut_[i] = PackPixel(r, g, b, 0xFF);
+        bgraLut_[i] = PackPixel(b, g, r, 0xFF);
+    }
+
+    opaqueBlack_ = PackPixel(0x00, 0x00, 0x00, 0xFF);
+
+#ifdef FRAME_CONVERTER_AVX2
+    useAvx2_ = __builtin_cpu_supports("avx2");
+#else
+    useAvx2_ = false;
+#endif
+}
+
+void FrameConverter::SetOverscan(bool enabled)
+{
+    overscan_ = enabled;
+}
+
+void FrameConverter::Convert(uint16_t const* frame, uint8_t* pixels, size_t pitch, PixelFormat format) const
+{
+    bool overscan = overscan_;
+
+    for (size_t row = 0; row < FRAME_HEIGHT; ++row)
+    {
+        if (overscan && ((row < OVERSCAN_TOP) || (row >= OVERSCAN_BOTTOM)))
+        {
+            ClearRow(pixels + (row * pitch), format);
+        }
+        else
+        {
+            ConvertRow(frame + (row * FRAME_WIDTH), pixels + (row * pitch), format);
+        }
+    }
+}
+
+void FrameConverter::ConvertRow(uint16_t const* src, uint8_t* dst, PixelFormat format) const
+{
+    uint32_t const* lut = (format == PixelFormat::BGRA8888) ? bgraLut_.data() : rgbaLut_.data();
+    size_t bytesPerPixel = BytesPerPixel(format);
+
+#ifdef FRAME_CONVERTER_AVX2
+    if (useAvx2_)
+    {
+        ConvertRowAvx2(src, dst, lut, bytesPerPixel);
+        return;
+    }
+#endif
+
+    if (bytesPerPixel == 4)
+    {
+        for (size_t x = 0; x < FRAME_WIDTH; ++x)
+        {
+            std::memcpy(dst + (x * 4), &lut[src[x] & (PIXEL_LUT_SIZE - 1)], 4);
+        }
+    }
+    else
+    {
+        for (size_t x = 0; x < FRAME_WIDTH; ++x)
+        {
+            std::memcpy(dst + (x * 3), &lut[src[x] & (PIXEL_LUT_SIZE - 1)], 3);
+        }
+    }
+}
+
+void FrameConverter::ClearRow(uint8_t* dst, PixelFormat format) const
+{
+    if (format == PixelFormat::RGB24)
+    {
+        std::memset(dst, 0x00, FRAME_WIDTH * 3);
+        return;
+    }
+
+    for (size_t x = 0; x < FRAME_WIDTH; ++x)
+    {
+        std::memcpy(dst + (x * 4), &opaqueBlack_, 4);
+    }
+}
@@ -1,10 +1,14 @@
 #include "../include/GameWindow.hpp"
 #include "../include/NesComponent.hpp"
 #include "../include/Paths.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <SDL2/SDL.h>
@@ -15,11 +19,11 @@
 #include <imfilebrowser.h>
 #include "../library/md5/md5.hpp"
 
-static double timePerNesClock = TIME_PER_NES_CLOCK;
+static std::atomic<double> timePerNesClock {TIME_PER_NES_CLOCK};
 
-GameWindow::GameWindow(NES& nes, uint8_t* frameBuffer, std::filesystem::path romPath) :
+GameWindow::GameWindow(NES& nes, std::filesystem::path romPath) :
     nes_(nes),
-    frameBuffer_(frameBuffer)
+    sampleRing_(AUDIO_RING_SIZE)
 {
     clockMultiplier_ = ClockMultiplier::NORMAL;
     romHash_ = "";
@@ -35,8 +39,21 @@ GameWindow::GameWindow(NES& nes, uint8_t* frameBuffer, std::filesystem::path rom
     pauseMenuOpen_ = !nes_.Ready();
     rightMenuOption_ = RightMenuOption::BLANK;
     overscan_ = false;
+    instructionStepping_ = true;
+    idleLoopSkipping_ = true;
+    frameSkip_ = 0;
+    scalerOption_ = 0;
+    scalerType_ = ScalerType::NONE;
+    ntscFilter_ = false;
+    ntscOutput_ = false;
+    presentedScaler_ = ScalerType::NONE;
+    refreshScreen_ = false;
+    cpuTrace_ = false;
     mute_ = false;
     audioVolume_ = 100;
+    sampleRateOption_ = DEFAULT_SAMPLE_RATE_OPTION;
+    audioDevice_ = 0;
+    audioSampleRate_ = AUDIO_SAMPLE_RATES[sampleRateOption_];
     windowScale_ = static_cast<WindowScale>(WINDOW_SCALE);
 
     LoadKeyBindings();
@@ -48,7 +65,15 @@ void GameWindow::Run()
     InitializeImGui();
     ScaleGui();
 
-    if (!pauseMenuOpen_)
+    // Only once ImGui is done setting up the renderer, since the presenter draws to it from then on
+    StartPresenter();
+    StartEmulation();
+
+    if (pauseMenuOpen_)
+    {
+        LockEmulation();
+    }
+    else
     {
         SDL_PauseAudioDevice(audioDevice_, 0);
     }
@@ -76,23 +101,23 @@ void GameWindow::Run()
                 }
                 else if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
                 {
+                    // The presenter owns the renderer while the game runs, so it redraws the frame at the new size
                     ScaleGui();
-                    SDL_RenderClear(renderer_);
-                    SDL_RenderPresent(renderer_);
+                    refreshScreen_ = true;
                 }
             }
             else if (event.type == SDL_DROPFILE)
             {
                 if (!pauseMenuOpen_)
                 {
-                    LockAudio();
+                    LockEmulation();
                 }
 
                 LoadCartridge(event.drop.file);
 
                 if (!pauseMenuOpen_)
                 {
-                    UnlockAudio();
+                    UnlockEmulation();
                 }
             }
             else if (event.type == SDL_KEYUP)
@@ -111,95 +136,159 @@ void GameWindow::Run()
 
             if (resetNES_)
             {
-                LockAudio();
+                LockEmulation();
                 nes_.Reset();
                 resetNES_ = false;
-                UnlockAudio();
+                UnlockEmulation();
             }
             else if (serialize_)
             {
                 serialize_ = false;
-                LockAudio();
+                LockEmulation();
                 CreateSaveState();
-                UnlockAudio();
+                UnlockEmulation();
             }
             else if (deserialize_)
             {
                 deserialize_ = false;
-                LockAudio();
+                LockEmulation();
                 LoadSaveState();
-                UnlockAudio();
+                UnlockEmulation();
             }
         }
 
         SDL_Delay(1);
     }
 
-    SDL_UnlockAudioDevice(audioDevice_);
+    StopEmulation();
+    SDL_CloseAudioDevice(audioDevice_);
+    StopPresenter();
     ImGui_ImplSDLRenderer_Shutdown();
     ImGui_ImplSDL2_Shutdown();
     ImGui::DestroyContext();
     SDL_DestroyRenderer(renderer_);
     SDL_DestroyWindow(window_);
-    SDL_CloseAudioDevice(audioDevice_);
     SDL_Quit();
 }
 
-int GameWindow::UpdateScreen(void* data)
+void GameWindow::UpdateScreen()
 {
-    GameWindow* gameWindow = static_cast<GameWindow*>(data);
-
-    SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(gameWindow->frameBuffer_,
-                                                    SCREEN_WIDTH,
-                                                    SCREEN_HEIGHT,
-                                                    DEPTH,
-                                                    PITCH,
-                                                    0x0000FF,
-                                                    0x00FF00,
-                                                    0xFF0000,
-                                                    0);
-
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(gameWindow->renderer_, surface);
-    SDL_RenderCopy(gameWindow->renderer_, texture, nullptr, nullptr);
-
-    SDL_RenderPresent(gameWindow->renderer_);
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
-    return 0;
+    uint16_t const* frameBuffer = nes_.GetFrameBuffer();
+    bool ntscOutput = ntscOutput_;
+    ScalerType scalerType = ntscOutput ? ScalerType::NONE : scalerType_.load();
+    int width = ntscOutput ? NTSC_FRAME_WIDTH : (SCREEN_WIDTH * ScaleFactor(scalerType));
+    int height = SCREEN_HEIGHT * ScaleFactor(scalerType);
+    uint8_t* pixels;
+    int pitch;
+
+    if ((width != textureWidth_) || (height != textureHeight_))
+    {
+        SDL_DestroyTexture(frameTexture_);
+        CreateFrameTexture(width, height);
+    }
+    else if ((frameBuffer == presentedFrame_) && (scalerType == presentedScaler_) && !refreshScreen_.exchange(false))
+    {
+        return;
+    }
+
+    presentedFrame_ = frameBuffer;
+    presentedScaler_ = scalerType;
+
+    if (SDL_LockTexture(frameTexture_, nullptr, (void**)&pixels, &pitch) == 0)
+    {
+        if (ntscOutput)
+        {
+            nes_.FilterFrame(frameBuffer, nes_.GetFramePhase(), pixels, pitch);
+        }
+        else if (scalerType == ScalerType::NONE)
+        {
+            nes_.ConvertFrame(frameBuffer, pixels, pitch, PixelFormat::BGRA8888);
+        }
+        else
+        {
+            // Scaled here so a slow scaler only ever holds up presenting, never emulation
+            size_t inputPitch = FRAME_WIDTH * sizeof(uint32_t);
+            nes_.ConvertFrame(frameBuffer, (uint8_t*)scalerInput_.get(), inputPitch, PixelFormat::BGRA8888);
+            scaler_->Scale(scalerType, scalerInput_.get(), pixels, pitch);
+        }
+
+        SDL_UnlockTexture(frameTexture_);
+    }
+
+    SDL_RenderCopy(renderer_, frameTexture_, nullptr, nullptr);
+    SDL_RenderPresent(renderer_);
 }
 
 void GameWindow::GetAudioSamples(void* userdata, Uint8* stream, int len)
 {
-    static double audioTime = 0.0;
     GameWindow* gameWindow = static_cast<GameWindow*>(userdata);
-    int numSamples = len / sizeof(int16_t);
+    size_t numSamples = len / sizeof(int16_t);
     int16_t* buffer = (int16_t*)stream;
     float audioVolume = gameWindow->audioVolume_ / 100.0;
 
-    for (int i = 0; i < numSamples; ++i)
+    // Only takes what the emulation thread has already made, anything it hasn't gotten to yet is played as silence
+    size_t samplesRead = gameWindow->sampleRing_.Read(buffer, numSamples);
+    std::fill(buffer + samplesRead, buffer + numSamples, 0);
+
+    for (size_t i = 0; i < numSamples; ++i)
     {
-        while (audioTime < TIME_PER_AUDIO_SAMPLE)
-        {
-            gameWindow->nes_.Clock();
-            audioTime += timePerNesClock;
+        buffer[i] = gameWindow->mute_ ? 0 : (buffer[i] * audioVolume);
+    }
+}
 
-            if (gameWindow->nes_.FrameReady())
-            {
-                SDL_WaitThread(gameWindow->renderThread_, nullptr);
-                gameWindow->renderThread_ = SDL_CreateThread(GameWindow::UpdateScreen, "UpdateScreen", gameWindow);
-            }
-        }
+void GameWindow::RunEmulation()
+{
+    using std::chrono::steady_clock;
+    using Seconds = std::chrono::duration<double>;
 
-        audioTime -= TIME_PER_AUDIO_SAMPLE;
+    std::vector<int16_t> samples(AUDIO_SAMPLE_BUFFER_COUNT);
+    steady_clock::time_point deadline = steady_clock::now();
+    bool resync = true;
+
+    while (emulationRunning_)
+    {
+        SDL_LockMutex(emulationMutex_);
+        steady_clock::time_point now = steady_clock::now();
 
-        if (gameWindow->mute_)
+        if (resync || (Seconds(now - deadline).count() > MAX_EMULATION_LAG))
         {
-            buffer[i] = 0;
+            // Starting out, or coming back from being held up. Time that went by is dropped and the ring is topped
+            // up with silence so the audio device has something to play while the NES gets going again.
+            deadline = now;
+            size_t fill = sampleRing_.Size();
+            sampleRing_.WriteSilence((fill < AUDIO_TARGET_FILL) ? (AUDIO_TARGET_FILL - fill) : 0);
+            resync = false;
         }
-        else
+        else if (deadline > now)
         {
-            buffer[i] = gameWindow->nes_.GetAudioSample() * audioVolume;
+            SDL_UnlockMutex(emulationMutex_);
+            std::this_thread::sleep_until(deadline);
+            continue;
         }
+
+        // Fewer samples per second of NES time while the ring is fuller than the target, more while it's emptier
+        double fillError = (static_cast<double>(sampleRing_.Size()) - AUDIO_TARGET_FILL) / AUDIO_TARGET_FILL;
+        double sampleRate = audioSampleRate_ * (1.0 - (MAX_RATE_ADJUSTMENT * std::clamp(fillError, -1.0, 1.0)));
+        double clockRate = 1.0 / timePerNesClock;
+
+        // Run the NES just long enough for a block of samples. The clock multiplier changes how many cycles that takes.
+        nes_.SetAudioRates(clockRate, sampleRate);
+        size_t cycles = nes_.CyclesUntilAudioSamples(samples.size());
+        deadline += std::chrono::duration_cast<steady_clock::duration>(Seconds(cycles / clockRate));
+
+        while (cycles > 0)
+        {
+            cycles -= nes_.Run(cycles);
+
+            if (nes_.FrameReady())
+            {
+                SignalFrameReady();
+            }
+        }
+
+        size_t samplesRead = nes_.ReadAudioSamples(samples.data(), samples.size());
+        sampleRing_.Write(samples.data(), samplesRead);
+        SDL_UnlockMutex(emulationMutex_);
     }
 }
 
@@ -263,7 +352,7 @@ void GameWindow::UpdateClockMultiplier(bool increase)
         {
             case ClockMultiplier::QUARTER ... ClockMultiplier::DOUBLE:
                 clockMultiplier_ = static_cast<ClockMultiplier>(static_cast<int>(clockMultiplier_) + 1);
-                timePerNesClock *= 0.5;
+                timePerNesClock = timePerNesClock * 0.5;
                 break;
             case ClockMultiplier::QUADRUPLE:
                 break;
@@ -275,7 +364,7 @@ void GameWindow::UpdateClockMultiplier(bool increase)
         {
             case ClockMultiplier::HALF ... ClockMultiplier::QUADRUPLE:
                 clockMultiplier_ = static_cast<ClockMultiplier>(static_cast<int>(clockMultiplier_) - 1);
-                timePerNesClock *= 2;
+                timePerNesClock = timePerNesClock * 2;
                 break;
             case ClockMultiplier::QUARTER:
                 break;
@@ -294,7 +383,10 @@ void GameWindow::CreateSaveState()
         saveStatePath += romHash_ + "_" + std::to_string(saveStateNum_);
         std::ofstream saveState(saveStatePath, std::ios::binary);
 
-        SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(frameBuffer_,
+        std::vector<uint8_t> screenshot(PITCH * SCREEN_HEIGHT);
+        nes_.ConvertFrame(nes_.GetLastFrame(), screenshot.data(), PITCH, PixelFormat::RGB24);
+
+        SDL_Surface* surface = SDL_CreateRGBSurfaceFrom(screenshot.data(),
                                                         SCREEN_WIDTH,
                                                         SCREEN_HEIGHT,
                                                         DEPTH,
@@ -176,6 +176,58 @@ void GameWindow::OptionsMenu()
                 ImGui::Checkbox("Overscan", &overscan_);
                 nes_.SetOverscan(overscan_);
 
+                // Instruction stepping toggle
+                ImGui::Checkbox("Instruction stepping", &instructionStepping_);
+                nes_.SetInstructionStepping(instructionStepping_);
+
+                // Idle loop skipping toggle
+                ImGui::Checkbox("Idle loop skipping", &idleLoopSkipping_);
+                nes_.SetIdleLoopSkipping(idleLoopSkipping_);
+
+                // Frameskip
+                static char const* const frameSkipOptions[] = {"Off", "Auto", "1", "2", "3"};
+                ImGui::Combo("Frameskip", &frameSkip_, frameSkipOptions, IM_ARRAYSIZE(frameSkipOptions));
+
+                if (frameSkip_ == 0)
+                {
+                    nes_.SetFrameSkip(FrameSkipMode::OFF);
+                }
+                else if (frameSkip_ == 1)
+                {
+                    nes_.SetFrameSkip(FrameSkipMode::ADAPTIVE);
+                }
+                else
+                {
+                    nes_.SetFrameSkip(FrameSkipMode::FIXED, frameSkip_ - 1);
+                }
+
+                // Scaler
+                auto scalerName = [](void*, int index, char const** name)
+                {
+                    *name = ScalerName(static_cast<ScalerType>(index));
+                    return true;
+                };
+
+                ImGui::Combo("Scaler", &scalerOption_, scalerName, nullptr, SCALER_COUNT);
+                scalerType_ = static_cast<ScalerType>(scalerOption_);
+
+                // NTSC filter toggle, used in place of the scaler
+                ImGui::Checkbox("NTSC filter", &ntscFilter_);
+                ntscOutput_ = ntscFilter_;
+
+                // CPU trace toggle, the emulation thread is already held while the menu is open
+                if (ImGui::Checkbox("CPU trace", &cpuTrace_))
+                {
+                    if (cpuTrace_)
+                    {
+                        cpuTrace_ = nes_.StartTrace(LOG_PATH / (fileName_ + ".trace"));
+                    }
+                    else
+                    {
+                        nes_.StopTrace();
+                    }
+                }
+
                 // Mute toggle
                 ImGui::Checkbox("Mute audio", &mute_);
 
@@ -183,6 +235,14 @@ void GameWindow::OptionsMenu()
                 ImGui::NewLine();
                 ImGui::SliderInt("Volume", &audioVolume_, 0, 100, "%d%%", ImGuiSliderFlags_NoInput);
 
+                // Sample rate, the device is reopened paused and picks up again when the menu closes
+                static char const* const sampleRateOptions[] = {"44.1 kHz", "48 kHz", "96 kHz"};
+
+                if (ImGui::Combo("Sample rate", &sampleRateOption_, sampleRateOptions, IM_ARRAYSIZE(sampleRateOptions)))
+                {
+                    OpenAudioDevice(AUDIO_SAMPLE_RATES[sampleRateOption_]);
+                }
+
                 // Key binding
                 ImGui::NewLine();
                 ImGui::Text("NES Controller");
@@ -468,7 +528,8 @@ void GameWindow::ClosePauseMenu()
     if (nes_.Ready())
     {
         pauseMenuOpen_ = false;
-        UnlockAudio();
+        refreshScreen_ = true;
+        UnlockEmulation();
     }
 }
 
@@ -2,6 +2,7 @@
 #include "../include/NesComponent.hpp"
 #include "../include/Paths.hpp"
 #include <filesystem>
+#include <memory>
 #include <utility>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -29,17 +30,7 @@ void GameWindow::InitializeSDL()
     SDL_SetWindowIcon(window_, surface);
     SDL_FreeSurface(surface);
 
-    // Audio setup
-    SDL_AudioSpec audioSpec;
-    SDL_zero(audioSpec);
-    audioSpec.freq = AUDIO_SAMPLE_RATE;
-    audioSpec.format = AUDIO_S16SYS;
-    audioSpec.channels = 1;
-    audioSpec.samples = AUDIO_SAMPLE_BUFFER_COUNT;
-    audioSpec.callback = GameWindow::GetAudioSamples;
-    audioSpec.userdata = this;
-    audioDevice_ = SDL_OpenAudioDevice(nullptr, 0, &audioSpec, nullptr, 0);
-    renderThread_ = nullptr;
+    OpenAudioDevice(AUDIO_SAMPLE_RATES[sampleRateOption_]);
 }
 
 void GameWindow::HandleSDLInputs(SDL_Scancode scancode)
@@ -54,6 +45,7 @@ void GameWindow::HandleSDLInputs(SDL_Scancode scancode)
         {
             overscan_ = !overscan_;
             nes_.SetOverscan(overscan_);
+            refreshScreen_ = true;
         }
         else if (scancode == keyBindings_[InputType::MUTE].second)
         {
@@ -73,7 +65,7 @@ void GameWindow::HandleSDLInputs(SDL_Scancode scancode)
             {
                 case SDL_SCANCODE_ESCAPE:
                     pauseMenuOpen_ = true;
-                    LockAudio();
+                    LockEmulation();
 
                     if ((rightMenuOption_ == RightMenuOption::SAVE) || (rightMenuOption_ == RightMenuOption::LOAD))
                     {
@@ -108,15 +100,135 @@ void GameWindow::UpdateTitle()
     SDL_SetWindowTitle(window_, (std::string("NES EMU - ") + fileName_).c_str());
 }
 
-void GameWindow::LockAudio()
+void GameWindow::OpenAudioDevice(int sampleRate)
+{
+    // The device is allowed to pick a different rate so SDL never converts behind our back, the APU resamples to
+    // whatever it ends up running at instead. Opens paused, like the first time.
+    if (audioDevice_ != 0)
+    {
+        SDL_CloseAudioDevice(audioDevice_);
+    }
+
+    SDL_AudioSpec audioSpec;
+    SDL_AudioSpec obtainedSpec;
+    SDL_zero(audioSpec);
+    audioSpec.freq = sampleRate;
+    audioSpec.format = AUDIO_S16SYS;
+    audioSpec.channels = 1;
+    audioSpec.samples = AUDIO_SAMPLE_BUFFER_COUNT;
+    audioSpec.callback = GameWindow::GetAudioSamples;
+    audioSpec.userdata = this;
+    audioDevice_ = SDL_OpenAudioDevice(nullptr, 0, &audioSpec, &obtainedSpec, SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    audioSampleRate_ = (audioDevice_ != 0) ? obtainedSpec.freq : sampleRate;
+}
+
+void GameWindow::StartEmulation()
+{
+    emulationMutex_ = SDL_CreateMutex();
+    emulationRunning_ = true;
+    emulationThread_ = SDL_CreateThread(GameWindow::EmulationThread, "Emulation", this);
+}
+
+void GameWindow::StopEmulation()
+{
+    // The main thread still holds the NES and the renderer if the pause menu is open
+    emulationRunning_ = false;
+
+    if (pauseMenuOpen_)
+    {
+        SDL_UnlockMutex(presenterMutex_);
+        SDL_UnlockMutex(emulationMutex_);
+    }
+
+    SDL_WaitThread(emulationThread_, nullptr);
+    SDL_DestroyMutex(emulationMutex_);
+}
+
+void GameWindow::LockEmulation()
 {
-    SDL_LockAudioDevice(audioDevice_);
+    // Waits for the block of samples being made and the frame being presented to finish at most, so the main thread
+    // can use the NES and draw to the renderer
+    SDL_LockMutex(emulationMutex_);
+    SDL_LockMutex(presenterMutex_);
     SDL_PauseAudioDevice(audioDevice_, 1);
-    SDL_Delay(20);
 }
 
-void GameWindow::UnlockAudio()
+void GameWindow::UnlockEmulation()
 {
-    SDL_UnlockAudioDevice(audioDevice_);
+    SDL_UnlockMutex(presenterMutex_);
+    SDL_UnlockMutex(emulationMutex_);
     SDL_PauseAudioDevice(audioDevice_, 0);
 }
+
+int GameWindow::EmulationThread(void* data)
+{
+    static_cast<GameWindow*>(data)->RunEmulation();
+    return 0;
+}
+
+void GameWindow::StartPresenter()
+{
+    CreateFrameTexture(SCREEN_WIDTH, SCREEN_HEIGHT);
+    scaler_ = std::make_unique<Scaler>();
+    scalerInput_ = std::make_unique<uint32_t[]>(FRAME_BUFFER_SIZE);
+
+    frameReadySemaphore_ = SDL_CreateSemaphore(0);
+    presenterMutex_ = SDL_CreateMutex();
+    presenterRunning_ = true;
+    presenterThread_ = SDL_CreateThread(GameWindow::PresenterThread, "Presenter", this);
+}
+
+void GameWindow::StopPresenter()
+{
+    // The emulation thread must already be stopped so it can't signal another frame
+    presenterRunning_ = false;
+    SDL_SemPost(frameReadySemaphore_);
+    SDL_WaitThread(presenterThread_, nullptr);
+    SDL_DestroySemaphore(frameReadySemaphore_);
+    SDL_DestroyMutex(presenterMutex_);
+    SDL_DestroyTexture(frameTexture_);
+    scaler_.reset();
+}
+
+void GameWindow::CreateFrameTexture(int width, int height)
+{
+    frameTexture_ = SDL_CreateTexture(renderer_,
+                                      SDL_PIXELFORMAT_BGRA32,
+                                      SDL_TEXTUREACCESS_STREAMING,
+                                      width,
+                                      height);
+
+    textureWidth_ = width;
+    textureHeight_ = height;
+    presentedFrame_ = nullptr;
+}
+
+void GameWindow::SignalFrameReady()
+{
+    // Don't queue up frames the presenter hasn't gotten to yet, it always shows the latest one
+    if (SDL_SemValue(frameReadySemaphore_) == 0)
+    {
+        SDL_SemPost(frameReadySemaphore_);
+    }
+}
+
+int GameWindow::PresenterThread(void* data)
+{
+    GameWindow* gameWindow = static_cast<GameWindow*>(data);
+
+    while (true)
+    {
+        SDL_SemWait(gameWindow->frameReadySemaphore_);
+
+        if (!gameWindow->presenterRunning_)
+        {
+            break;
+        }
+
+        SDL_LockMutex(gameWindow->presenterMutex_);
+        gameWindow->UpdateScreen();
+        SDL_UnlockMutex(gameWindow->presenterMutex_);
+    }
+
+    return 0;
+}
@@ -0,0 +1,742 @@
+#include "../include/CPU.hpp"
+#include "../include/APU.hpp"
+#include "../include/Cartridge.hpp"
+#include "../include/PPU.hpp"
+#include "../include/RegisterAddresses.hpp"
+#include <algorithm>
+#include <cstdint>
+
+// Instruction stepping executes a whole instruction per call instead of one cycle per Clock(). The PPU and APU are left
+// behind and only caught up to the CPU when an instruction accesses a register that can observe or change their state.
+// Instructions are only stepped when the event horizon shows that no DMC request, interrupt, vblank, or completed frame
+// can occur before they finish, and anything that happens closer than that is left to the cycle-by-cycle core. Every
+// function here mirrors its counterpart in AddressingModes.cpp and Instructions.cpp.
+
+bool CPU::CanStepInstruction(size_t cycles)
+{
+    if (!Serializable())
+    {
+        return false;
+    }
+
+    InstructionEntry const& entry = INSTRUCTION_TABLE[static_cast<uint8_t>(opCode_)];
+
+    if ((entry.stepFunction == nullptr) || (entry.maxCycles > cycles))
+    {
+        return false;
+    }
+
+    // One cycle of margin covers the PPU running ahead on $2000/$2002 accesses.
+    return totalCycles_ + entry.maxCycles + 1 < eventCycle_;
+}
+
+size_t CPU::StepInstruction()
+{
+    uint64_t startCycle = totalCycles_;
+    uint16_t instructionAddr = Registers_.programCounter - 1;
+    InstructionEntry const& entry = INSTRUCTION_TABLE[static_cast<uint8_t>(opCode_)];
+    stepEndCycle_ = startCycle + entry.maxCycles;
+    SetOperandPage();
+    Tick();
+    LoadInstruction(entry);
+    (this->*entry.stepFunction)();
+
+    if (idleLoopSkipping_)
+    {
+        TrackIdleLoop(instructionAddr);
+    }
+
+    return totalCycles_ - startCycle;
+}
+
+void CPU::CatchUp()
+{
+    // The PPU and APU don't affect each other, so each can be run through the whole gap in one go.
+    if (syncedCycles_ < totalCycles_)
+    {
+        ppu_.Run(totalCycles_ - syncedCycles_);
+        apu_.Run(totalCycles_ - syncedCycles_);
+        syncedCycles_ = totalCycles_;
+    }
+}
+
+void CPU::UpdateEventHorizon()
+{
+    eventCycle_ = totalCycles_ + std::min(ppu_.CyclesUntilEvent(), apu_.CyclesUntilEvent()) + 1;
+}
+
+void CPU::Tick()
+{
+    oddCycle_ = !oddCycle_;
+    ++totalCycles_;
+}
+
+uint8_t CPU::SyncedRead(uint16_t addr)
+{
+    if ((addr < IO_REGISTERS_START) || (addr >= IO_REGISTERS_END))
+    {
+        return Read(addr);
+    }
+
+    CatchUp();
+
+    if (idleLoopClean_)
+    {
+        // PPUSTATUS is the only register an idle loop may poll. The first read bounds how long it stays the same.
+        if ((addr < 0x4000) && ((addr % 0x0008) == (PPUSTATUS_ADDR % 0x0008)))
+        {
+            if (!idleLoopReadsStatus_)
+            {
+                idleLoopReadsStatus_ = true;
+                idleLoopStatusLimit_ = totalCycles_ + ppu_.CyclesUntilStatusChange();
+            }
+        }
+        else
+        {
+            idleLoopClean_ = false;
+        }
+    }
+
+    uint8_t data = Read(addr);
+    UpdateEventHorizon();
+    return data;
+}
+
+void CPU::SyncedWrite(uint16_t addr, uint8_t data)
+{
+    // Mappers like CNROM decode registers from any write to cartridge space, so everything outside of RAM and directly
+    // mapped PRG RAM is synced.
+    if ((addr < IO_REGISTERS_START) || (cartridge_->GetPrgWritePage(addr) != nullptr))
+    {
+        Write(addr, data);
+        return;
+    }
+
+    CatchUp();
+    Write(addr, data);
+    UpdateEventHorizon();
+}
+
+uint8_t CPU::SyncedReadAndIncrementPC()
+{
+    if (operandPage_ != nullptr)
+    {
+        return operandPage_[Registers_.programCounter++ % PRG_PAGE_SIZE];
+    }
+
+    uint8_t data = SyncedRead(Registers_.programCounter);
+    ++Registers_.programCounter;
+    return data;
+}
+
+void CPU::SetOperandPage()
+{
+    // PRG ROM can't change under a mapping, so the page an instruction was fetched from already holds its decoded form:
+    // the opcode selects the handler and cycle count from INSTRUCTION_TABLE and the operand bytes are read straight
+    // from the page. Bank switches are picked up because the page is looked up again for every instruction. Code in
+    // RAM, writable PRG RAM, or with operands spilling into the next page is fetched through the bus.
+    uint16_t offset = Registers_.programCounter % PRG_PAGE_SIZE;
+
+    if ((offset > PRG_PAGE_SIZE - 2) || (cartridge_->GetPrgWritePage(Registers_.programCounter) != nullptr))
+    {
+        operandPage_ = nullptr;
+        return;
+    }
+
+    operandPage_ = cartridge_->GetPrgReadPage(Registers_.programCounter);
+}
+
+void CPU::SyncedNextOpCode()
+{
+    if ((Registers_.programCounter < IO_REGISTERS_START) || (Registers_.programCounter >= IO_REGISTERS_END))
+    {
+        SetNextOpCode();
+        return;
+    }
+
+    CatchUp();
+    SetNextOpCode();
+    UpdateEventHorizon();
+}
+
+bool CPU::DeferToClock(size_t cycle)
+{
+    // A write that started OAM DMA or brought an event closer than the end of the instruction hands the rest of the
+    // instruction to the cycle-by-cycle core, which resumes tickFunction_ after the given cycle.
+    if (!isOamDmaTransfer_ && (stepEndCycle_ + 1 < eventCycle_))
+    {
+        return false;
+    }
+
+    cycle_ = cycle;
+    postOamDmaReturnCycle_ = cycle;
+    return true;
+}
+
+void CPU::StepImmediate()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepAbsolute()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iData_;
+    Tick();
+
+    if (isStoreOp_)
+    {
+        SyncedWrite(iAddr_, regData_);
+
+        if (DeferToClock(3))
+        {
+            return;
+        }
+    }
+    else
+    {
+        iData_ = SyncedRead(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepZeroPage()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+
+    if (isStoreOp_)
+    {
+        Write(iAddr_, regData_);
+    }
+    else
+    {
+        iData_ = Read(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepImplied()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepAbsoluteIndexed()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iData_;
+    Tick();
+
+    if (isStoreOp_ || (((iAddr_ + instructionIndex_) & PAGE_MASK) != (iAddr_ & PAGE_MASK)))
+    {
+        // Dummy Read
+        SyncedRead((iAddr_ & PAGE_MASK) | ((iAddr_ + instructionIndex_) & ZERO_PAGE_MASK));
+        iAddr_ += instructionIndex_;
+        Tick();
+
+        if (isStoreOp_)
+        {
+            SyncedWrite(iAddr_, regData_);
+
+            if (DeferToClock(4))
+            {
+                return;
+            }
+        }
+        else
+        {
+            iData_ = SyncedRead(iAddr_);
+        }
+    }
+    else
+    {
+        iAddr_ += instructionIndex_;
+        iData_ = SyncedRead(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepZeroPageIndexed()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    // Dummy Read
+    Read(iAddr_);
+    iAddr_ = (iAddr_ + instructionIndex_) & ZERO_PAGE_MASK;
+    Tick();
+
+    if (isStoreOp_)
+    {
+        Write(iAddr_, regData_);
+    }
+    else
+    {
+        iData_ = Read(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepIndirectX()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    // Dummy Read
+    Read(iData_);
+    iData_ = (iData_ + Registers_.x) & ZERO_PAGE_MASK;
+    Tick();
+    iAddr_ = Read(iData_);
+    iData_ = (iData_ + 0x01) & ZERO_PAGE_MASK;
+    Tick();
+    iAddr_ = (Read(iData_) << 8) | iAddr_;
+    Tick();
+
+    if (isStoreOp_)
+    {
+        SyncedWrite(iAddr_, regData_);
+
+        if (DeferToClock(5))
+        {
+            return;
+        }
+    }
+    else
+    {
+        iData_ = SyncedRead(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepIndirectY()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = Read(iData_);
+    ++iData_;
+    Tick();
+    iAddr_ |= (Read(iData_) << 8);
+    Tick();
+
+    if (isStoreOp_ || (((iAddr_ + Registers_.y) & PAGE_MASK) != (iAddr_ & PAGE_MASK)))
+    {
+        // Dummy Read
+        SyncedRead((iAddr_ & PAGE_MASK) | ((iAddr_ + Registers_.y) & ZERO_PAGE_MASK));
+        iAddr_ += Registers_.y;
+        Tick();
+
+        if (isStoreOp_)
+        {
+            SyncedWrite(iAddr_, regData_);
+
+            if (DeferToClock(5))
+            {
+                return;
+            }
+        }
+        else
+        {
+            iData_ = SyncedRead(iAddr_);
+        }
+    }
+    else
+    {
+        iAddr_ += Registers_.y;
+        iData_ = SyncedRead(iAddr_);
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedNextOpCode();
+}
+
+void CPU::StepRelative()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    iAddr_ = Registers_.programCounter + (int8_t)iData_;
+    Tick();
+
+    if (!branchCondition_)
+    {
+        SyncedNextOpCode();
+        return;
+    }
+
+    // Dummy Read when branch condition is true
+    SyncedRead((Registers_.programCounter & PAGE_MASK) + (iAddr_ & ZERO_PAGE_MASK));
+    Tick();
+
+    if ((Registers_.programCounter & PAGE_MASK) != (iAddr_ & PAGE_MASK))
+    {
+        // Dummy Read when page boundary crossed on branch
+        SyncedRead(iAddr_);
+        Tick();
+    }
+
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepAccumulator()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    iData_ = Registers_.accumulator;
+    Tick();
+    (this->*instruction_)();
+    Registers_.accumulator = iData_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepZeroPageRMW()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    iData_ = Read(iAddr_);
+    Tick();
+    // Dummy Write
+    Write(iAddr_, 0xFF);
+    Tick();
+    (this->*instruction_)();
+    Write(iAddr_, iData_);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepZeroPageIndexedRMW()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    // Dummy Read
+    Read(iAddr_);
+    iAddr_ = (iAddr_ + instructionIndex_) % ZERO_PAGE_MASK;
+    Tick();
+    iData_ = Read(iAddr_);
+    Tick();
+    // Dummy Write
+    Write(iAddr_, 0xFF);
+    Tick();
+    (this->*instruction_)();
+    Write(iAddr_, iData_);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepAbsoluteRWM()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iAddr_;
+    Tick();
+    iData_ = SyncedRead(iAddr_);
+    Tick();
+    // Dummy Write
+    SyncedWrite(iAddr_, 0xFF);
+
+    if (DeferToClock(4))
+    {
+        return;
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedWrite(iAddr_, iData_);
+
+    if (DeferToClock(5))
+    {
+        return;
+    }
+
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepAbsoluteIndexedRMW()
+{
+    iData_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    // Dummy Read
+    SyncedRead((iAddr_ << 8) | ((iData_ + instructionIndex_) & ZERO_PAGE_MASK));
+    iAddr_ = (((iAddr_ << 8) | iData_) + instructionIndex_) & 0xFFFF;
+    Tick();
+    iData_ = SyncedRead(iAddr_);
+    Tick();
+    // Dummy Write
+    SyncedWrite(iAddr_, 0xFF);
+
+    if (DeferToClock(5))
+    {
+        return;
+    }
+
+    Tick();
+    (this->*instruction_)();
+    SyncedWrite(iAddr_, iData_);
+
+    if (DeferToClock(6))
+    {
+        return;
+    }
+
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepBRK()
+{
+    SyncedReadAndIncrementPC();
+    Tick();
+    Push(Registers_.programCounter >> 8);
+    Tick();
+    Push(Registers_.programCounter & ZERO_PAGE_MASK);
+    Tick();
+    Push(GetStatus() | 0x30);
+    Tick();
+    iAddr_ = Read(BRK_VECTOR_LO);
+    Tick();
+    iAddr_ = (Read(BRK_VECTOR_HI) << 8) | iAddr_;
+    Tick();
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepJSR()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    // Dummy Read
+    Read(STACK_PAGE | Registers_.stackPointer);
+    Tick();
+    Push(Registers_.programCounter >> 8);
+    Tick();
+    Push(Registers_.programCounter & ZERO_PAGE_MASK);
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iAddr_;
+    Tick();
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepPHA()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    Push(Registers_.accumulator);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepPHP()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    Push(GetStatus() | 0x30);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepPLA()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    // Dummy Read
+    Read(STACK_PAGE | Registers_.stackPointer);
+    Tick();
+    Registers_.accumulator = Pop();
+    SetNegativeZero(Registers_.accumulator);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepPLP()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    // Dummy Read
+    Read(STACK_PAGE | Registers_.stackPointer);
+    Tick();
+    SetStatus((Pop() & 0xCF) | 0x20);
+    Tick();
+    SyncedNextOpCode();
+}
+
+void CPU::StepRTI()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    // Dummy Read
+    Read(STACK_PAGE | Registers_.stackPointer);
+    Tick();
+    SetStatus((Pop() & 0xCF) | 0x20);
+    Tick();
+    iAddr_ = Pop();
+    Tick();
+    iAddr_ = (Pop() << 8) | iAddr_;
+    Tick();
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepRTS()
+{
+    // Dummy Read
+    SyncedRead(Registers_.programCounter);
+    Tick();
+    // Dummy Read
+    Read(STACK_PAGE | Registers_.stackPointer);
+    Tick();
+    iAddr_ = Pop();
+    Tick();
+    iAddr_ = (Pop() << 8) | iAddr_;
+    Tick();
+    // Dummy Read
+    SyncedRead(iAddr_);
+    Tick();
+    Registers_.programCounter = iAddr_ + 0x0001;
+    SyncedNextOpCode();
+}
+
+void CPU::StepAbsoluteJMP()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iAddr_;
+    Tick();
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+void CPU::StepIndirectJMP()
+{
+    iAddr_ = SyncedReadAndIncrementPC();
+    Tick();
+    iAddr_ = (SyncedReadAndIncrementPC() << 8) | iAddr_;
+    Tick();
+    iData_ = SyncedRead(iAddr_);
+    iAddr_ = (iAddr_ & PAGE_MASK) | ((iAddr_ + 0x0001) & ZERO_PAGE_MASK);
+    Tick();
+    iAddr_ = (SyncedRead(iAddr_) << 8) | iData_;
+    Tick();
+    Registers_.programCounter = iAddr_;
+    SyncedNextOpCode();
+}
+
+// Idle loops are loops that wait on an interrupt or a PPU status flag, like "JMP *" or "LDA $2002 / BPL". An iteration
+// that only reads RAM, PRG, or PPUSTATUS and ends with the same registers it started with will repeat exactly until an
+// interrupt, DMC request, or PPUSTATUS change, so the remaining iterations up to the earliest of those can be skipped by
+// advancing the CPU's cycle count. The PPU and APU then catch up as usual.
+
+size_t CPU::SkipIdleLoop(size_t cycles)
+{
+    if (idleLoopLength_ == 0)
+    {
+        return 0;
+    }
+
+    size_t length = idleLoopLength_;
+    idleLoopLength_ = 0;
+
+    // Stop at least one iteration short of anything that could end the loop and let it be stepped normally. Traces
+    // record every instruction, so nothing is skipped while tracing.
+    uint64_t limit = idleLoopReadsStatus_ ? std::min(eventCycle_, idleLoopStatusLimit_) : eventCycle_;
+    uint64_t skip = 0;
+
+    if ((trace_ == nullptr) && (totalCycles_ + (2 * length) < limit))
+    {
+        size_t iterations = std::min((limit - totalCycles_ - 1) / length - 1, cycles / length);
+        skip = iterations * length;
+        totalCycles_ += skip;
+
+        if ((skip % 2) == 1)
+        {
+            oddCycle_ = !oddCycle_;
+        }
+    }
+
+    // The skipped iterations changed nothing, so keep watching the loop from here.
+    WatchIdleLoop(idleLoopHead_);
+    return skip;
+}
+
+void CPU::SetIdleLoopSkipping(bool enabled)
+{
+    idleLoopSkipping_ = enabled;
+    idleLoopLength_ = 0;
+}
+
+void CPU::TrackIdleLoop(uint16_t instructionAddr)
+{
+    // Anything other than fetching the next opcode (an interrupt, or the rest of the instruction being deferred to
+    // Clock) isn't part of an idle loop.
+    if (cycle_ != 0)
+    {
+        idleLoopClean_ = false;
+        return;
+    }
+
+    uint16_t nextAddr = Registers_.programCounter - 1;
+
+    if (nextAddr > instructionAddr)
+    {
+        return;
+    }
+
+    if (idleLoopClean_ && (nextAddr == idleLoopHead_) && IdleLoopRegistersUnchanged())
+    {
+        idleLoopLength_ = totalCycles_ - idleLoopHeadCycle_;
+        return;
+    }
+
+    WatchIdleLoop(nextAddr);
+}
+
+void CPU::WatchIdleLoop(uint16_t head)
+{
+    idleLoopClean_ = true;
+    idleLoopReadsStatus_ = false;
+    idleLoopHead_ = head;
+    idleLoopHeadCycle_ = totalCycles_;
+    idleLoopRegisters_.accumulator = Registers_.accumulator;
+    idleLoopRegisters_.status = GetStatus();
+    idleLoopRegisters_.stackPointer = Registers_.stackPointer;
+    idleLoopRegisters_.x = Registers_.x;
+    idleLoopRegisters_.y = Registers_.y;
+}
+
+bool CPU::IdleLoopRegistersUnchanged() const
+{
+    return (idleLoopRegisters_.accumulator == Registers_.accumulator) &&
+           (idleLoopRegisters_.status == GetStatus()) &&
+           (idleLoopRegisters_.stackPointer == Registers_.stackPointer) &&
+           (idleLoopRegisters_.x == Registers_.x) &&
+           (idleLoopRegisters_.y == Registers_.y);
+}
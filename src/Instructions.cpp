@@ -4,9 +4,8 @@
 void CPU::ADC()
 {
     uint16_t temp = iData_ + Registers_.accumulator + (IsCarry() ? 1 : 0);
-    SetZero((temp & 0x00FF) == 0x0000);
-    SetNegative((temp & MSB) == MSB);
-    SetOverflow((((Registers_.accumulator ^ iData_) & 0x80) != 0x80) && (((Registers_.accumulator ^ temp) & 0x80) == 0x80));
+    SetNegativeZero(temp & 0x00FF);
+    overflowResult_ = ~(Registers_.accumulator ^ iData_) & (Registers_.accumulator ^ temp);
     SetCarry(temp > 0xFF);
     Registers_.accumulator = temp & 0xFF;
 }
@@ -14,8 +13,7 @@ void CPU::ADC()
 void CPU::AND()
 {
     iData_ &= Registers_.accumulator;
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
     Registers_.accumulator = iData_;
 }
 
@@ -23,15 +21,14 @@ void CPU::ASL()
 {
     SetCarry((iData_ & MSB) == MSB);
     iData_ <<= 1;
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
 }
 
 void CPU::BIT()
 {
-    SetNegative((iData_ & NEGATIVE_FLAG) == NEGATIVE_FLAG);
-    SetOverflow((iData_ & OVERFLOW_FLAG) == OVERFLOW_FLAG);
-    SetZero((iData_ & Registers_.accumulator) == 0);
+    negativeResult_ = iData_;
+    overflowResult_ = iData_ << 1;
+    zeroResult_ = iData_ & Registers_.accumulator;
 }
 
 void CPU::BRK()
@@ -48,7 +45,7 @@ void CPU::BRK()
             Push(Registers_.programCounter & ZERO_PAGE_MASK);
             break;
         case 4:
-            Push(Registers_.status | 0x30);
+            Push(GetStatus() | 0x30);
             break;
         case 5:
             iAddr_ = Read(BRK_VECTOR_LO);
@@ -62,61 +59,73 @@ void CPU::BRK()
     }
 }
 
+void CPU::CLC()
+{
+    SetCarry(false);
+}
+
+void CPU::CLD()
+{
+    SetDecimal(false);
+}
+
+void CPU::CLI()
+{
+    SetInterruptDisable(false);
+}
+
+void CPU::CLV()
+{
+    SetOverflow(false);
+}
+
 void CPU::CMP()
 {
     uint16_t temp = regData_ - iData_;
     SetCarry(temp < 0x0100);
-    SetNegative((temp & MSB) == MSB);
-    SetZero((temp & 0xFF) == 0x0000);
+    SetNegativeZero(temp & 0xFF);
 }
 
 void CPU::DEC()
 {
     --iData_;
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
 }
 
 void CPU::DEX()
 {
     --Registers_.x;
-    SetNegative((Registers_.x & MSB) == MSB);
-    SetZero(Registers_.x == 0x00);
+    SetNegativeZero(Registers_.x);
 }
 
 void CPU::DEY()
 {
     --Registers_.y;
-    SetNegative((Registers_.y & MSB) == MSB);
-    SetZero(Registers_.y == 0x00);
+    SetNegativeZero(Registers_.y);
 }
 
 void CPU::EOR()
 {
     Registers_.accumulator ^= iData_;
-    SetNegative((Registers_.accumulator & MSB) == MSB);
-    SetZero(Registers_.accumulator == 0x00);
+    SetNegativeZero(Registers_.accumulator);
 }
 
 void CPU::INC()
 {
     ++iData_;
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
 }
 
 void CPU::INX()
 {
     ++Registers_.x;
-    SetNegative((Registers_.x & MSB) == MSB);
-    SetZero(Registers_.x == 0x00);
+    SetNegativeZero(Registers_.x);
 }
 
 void CPU::INY()
 {
     ++Registers_.y;
-    SetNegative((Registers_.y & MSB) == MSB);
-    SetZero(Registers_.y == 0x00);
+    SetNegativeZero(Registers_.y);
 }
 
 void CPU::JSR()
@@ -148,37 +157,36 @@ void CPU::JSR()
 void CPU::LDA()
 {
     Registers_.accumulator = iData_;
-    SetNegative((Registers_.accumulator & MSB) == MSB);
-    SetZero(Registers_.accumulator == 0x00);
+    SetNegativeZero(Registers_.accumulator);
 }
 
 void CPU::LDX()
 {
     Registers_.x = iData_;
-    SetNegative((Registers_.x & MSB) == MSB);
-    SetZero(Registers_.x == 0x00);
+    SetNegativeZero(Registers_.x);
 }
 
 void CPU::LDY()
 {
     Registers_.y = iData_;
-    SetNegative((Registers_.y & MSB) == MSB);
-    SetZero(Registers_.y == 0x00);
+    SetNegativeZero(Registers_.y);
 }
 
 void CPU::LSR()
 {
     SetCarry((iData_ & LSB) == LSB);
     iData_ >>= 1;
-    SetNegative(false);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
+}
+
+void CPU::NOP()
+{
 }
 
 void CPU::ORA()
 {
     Registers_.accumulator |= iData_;
-    SetNegative((Registers_.accumulator & MSB) == MSB);
-    SetZero(Registers_.accumulator == 0x00);
+    SetNegativeZero(Registers_.accumulator);
 }
 
 void CPU::PHA()
@@ -206,7 +214,7 @@ void CPU::PHP()
             Read(Registers_.programCounter);
             break;
         case 2:
-            Push(Registers_.status | 0x30);
+            Push(GetStatus() | 0x30);
             break;
         case 3:
             SetNextOpCode();
@@ -227,8 +235,7 @@ void CPU::PLA()
             break;
         case 3:
             Registers_.accumulator = Pop();
-            SetNegative((Registers_.accumulator & MSB) == MSB);
-            SetZero(Registers_.accumulator == 0x00);
+            SetNegativeZero(Registers_.accumulator);
             break;
         case 4:
             SetNextOpCode();
@@ -248,8 +255,7 @@ void CPU::PLP()
             Read(STACK_PAGE | Registers_.stackPointer);
             break;
         case 3:
-            Registers_.status = Pop() & 0xCF;
-            Registers_.status |= 0x20;
+            SetStatus((Pop() & 0xCF) | 0x20);
             break;
         case 4:
             SetNextOpCode();
@@ -265,8 +271,7 @@ void CPU::ROL()
     {
         iData_ |= LSB;
     }
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
 }
 
 void CPU::ROR()
@@ -278,8 +283,7 @@ void CPU::ROR()
     {
         iData_ |= MSB;
     }
-    SetNegative((iData_ & MSB) == MSB);
-    SetZero(iData_ == 0x00);
+    SetNegativeZero(iData_);
 }
 
 void CPU::RTI()
@@ -295,8 +299,7 @@ void CPU::RTI()
             Read(STACK_PAGE | Registers_.stackPointer);
             break;
         case 3:
-            Registers_.status = Pop() & 0xCF;
-            Registers_.status |= 0x20;
+            SetStatus((Pop() & 0xCF) | 0x20);
             break;
         case 4:
             iAddr_ = Pop();
@@ -347,39 +350,49 @@ void CPU::SBC()
         --temp;
     }
 
-    SetNegative((temp & MSB) == MSB);
-    SetZero((temp & 0x00FF) == 0x0000);
-    SetOverflow((((Registers_.accumulator ^ temp) & 0x0080) == 0x0080) && (((Registers_.accumulator ^ iData_) & 0x0080) == 0x0080));
+    SetNegativeZero(temp & 0x00FF);
+    overflowResult_ = (Registers_.accumulator ^ temp) & (Registers_.accumulator ^ iData_);
     SetCarry(temp < 0x0100);
     Registers_.accumulator = temp & 0x00FF;
 }
 
+void CPU::SEC()
+{
+    SetCarry(true);
+}
+
+void CPU::SED()
+{
+    SetDecimal(true);
+}
+
+void CPU::SEI()
+{
+    SetInterruptDisable(true);
+}
+
 void CPU::TAX()
 {
     Registers_.x = Registers_.accumulator;
-    SetNegative((Registers_.x & MSB) == MSB);
-    SetZero(Registers_.x == 0x00);
+    SetNegativeZero(Registers_.x);
 }
 
 void CPU::TAY()
 {
     Registers_.y = Registers_.accumulator;
-    SetNegative((Registers_.y & MSB) == MSB);
-    SetZero(Registers_.y == 0x00);
+    SetNegativeZero(Registers_.y);
 }
 
 void CPU::TSX()
 {
     Registers_.x = Registers_.stackPointer;
-    SetNegative((Registers_.x & MSB) == MSB);
-    SetZero(Registers_.x == 0x00);
+    SetNegativeZero(Registers_.x);
 }
 
 void CPU::TXA()
 {
     Registers_.accumulator = Registers_.x;
-    SetNegative((Registers_.accumulator & MSB) == MSB);
-    SetZero(Registers_.accumulator == 0x00);
+    SetNegativeZero(Registers_.accumulator);
 }
 
 void CPU::TXS()
@@ -390,8 +403,7 @@ void CPU::TXS()
 void CPU::TYA()
 {
     Registers_.accumulator = Registers_.y;
-    SetNegative((Registers_.accumulator & MSB) == MSB);
-    SetZero(Registers_.accumulator == 0x00);
+    SetNegativeZero(Registers_.accumulator);
 }
 
 void CPU::AbsoluteJMP()
@@ -3,6 +3,7 @@
 #include "../include/Cartridge.hpp"
 #include "../include/CPU.hpp"
 #include "../include/Controller.hpp"
+#include "../include/CpuTrace.hpp"
 #include "../include/DmcChannel.hpp"
 #include "../include/NoiseChannel.hpp"
 #include "../include/PulseChannel.hpp"
@@ -15,24 +16,51 @@
 #include "../include/mappers/NROM.hpp"
 #include "../include/mappers/UxROM.hpp"
 #include "../include/PPU.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <string>
 
-NES::NES(uint8_t* frameBuffer, std::ifstream& normalColors, std::ifstream& grayscaleColors)
+NES::NES(std::ifstream& normalColors, std::ifstream& grayscaleColors) :
+    readyFrame_(1),
+    backFrame_(0),
+    frontFrame_(2),
+    lastFrame_(1),
+    frameConverter_(normalColors, grayscaleColors),
+    frameSkipMode_(FrameSkipMode::OFF),
+    frameSkipCount_(0),
+    framesSkipped_(0),
+    frameSkipped_(false),
+    framesUnchanged_(0),
+    reusedFrames_(0)
 {
+    for (auto& frameBuffer : frameBuffers_)
+    {
+        frameBuffer = std::make_unique<uint16_t[]>(FRAME_BUFFER_SIZE);
+    }
+
+    framePhases_.fill(0);
+
     apu_ = std::make_unique<APU>();
     controller_ = std::make_unique<Controller>();
-    ppu_ = std::make_unique<PPU>(frameBuffer, normalColors, grayscaleColors);
+    ppu_ = std::make_unique<PPU>();
+    ppu_->SetFrameBuffer(frameBuffers_[backFrame_].get());
     cpu_ = std::make_unique<CPU>(*apu_, *controller_, *ppu_);
     cartridge_ = nullptr;
     cartLoaded_ = false;
+    instructionStepping_ = true;
+    frameReady_ = false;
 }
 
 NES::~NES()
 {
+    StopTrace();
+
     if (cartLoaded_)
     {
         cartridge_->SaveRAM();
@@ -63,12 +91,37 @@ bool NES::Ready()
 
 bool NES::FrameReady()
 {
-    return ppu_->FrameReady();
+    if (frameReady_)
+    {
+        frameReady_ = false;
+        return true;
+    }
+
+    if (ppu_->FrameReady())
+    {
+        FrameCompleted();
+        return true;
+    }
+
+    return false;
+}
+
+void NES::SetAudioRates(double clockRate, double sampleRate)
+{
+    // clockRate is how many CPU cycles are run per second of audio
+    apu_->SetAudioRates(clockRate, sampleRate);
+}
+
+size_t NES::CyclesUntilAudioSamples(size_t count)
+{
+    // CPU cycles to run before ReadAudioSamples() can fill count samples
+    return apu_->CyclesUntilSamples(count);
 }
 
-int16_t NES::GetAudioSample()
+size_t NES::ReadAudioSamples(int16_t* buffer, size_t count)
 {
-    return apu_->GetSample();
+    // Returns the number of samples read, at most count
+    return apu_->ReadSamples(buffer, count);
 }
 
 bool NES::LoadCartridge(std::filesystem::path romPath, std::filesystem::path savePath)
@@ -82,6 +135,7 @@ bool NES::LoadCartridge(std::filesystem::path romPath, std::filesystem::path sav
     }
 
     InitializeCartridge(romPath, savePath);
+    reusedFrames_ = 0;
 
     if (cartLoaded_)
     {
@@ -102,6 +156,88 @@ void NES::Clock()
     }
 }
 
+size_t NES::Run(size_t cycles)
+{
+    // Run up to the specified number of CPU cycles, stopping early on the cycle that completes a frame. Whole instructions
+    // are executed with the PPU and APU lagging behind when nothing can observe the difference, otherwise everything is
+    // clocked one cycle at a time. Returns the number of CPU cycles run.
+    if (!cartLoaded_)
+    {
+        return cycles;
+    }
+
+    size_t cyclesRun = 0;
+    cpu_->UpdateEventHorizon();
+
+    while (cyclesRun < cycles)
+    {
+        if (instructionStepping_ && cpu_->CanStepInstruction(cycles - cyclesRun))
+        {
+            cyclesRun += cpu_->StepInstruction();
+            cyclesRun += cpu_->SkipIdleLoop(cycles - cyclesRun);
+            continue;
+        }
+
+        cpu_->CatchUp();
+        ppu_->Clock();
+        apu_->Clock();
+        cpu_->Clock();
+        ++cyclesRun;
+
+        if (ppu_->FrameReady())
+        {
+            FrameCompleted();
+            frameReady_ = true;
+            break;
+        }
+        else if (instructionStepping_)
+        {
+            cpu_->UpdateEventHorizon();
+        }
+    }
+
+    cpu_->CatchUp();
+    return cyclesRun;
+}
+
+size_t NES::RunProfiled(size_t cycles, ComponentTimes& times)
+{
+    // Clock every component one cycle at a time like Clock(), adding the time spent in each one's Clock() to times. Stops
+    // early on the cycle that completes a frame. Returns the number of CPU cycles run.
+    if (!cartLoaded_)
+    {
+        return cycles;
+    }
+
+    using std::chrono::steady_clock;
+    size_t cyclesRun = 0;
+
+    while (cyclesRun < cycles)
+    {
+        auto ppuStart = steady_clock::now();
+        ppu_->Clock();
+        auto apuStart = steady_clock::now();
+        apu_->Clock();
+        auto cpuStart = steady_clock::now();
+        cpu_->Clock();
+        auto cpuEnd = steady_clock::now();
+
+        times.ppu += apuStart - ppuStart;
+        times.apu += cpuStart - apuStart;
+        times.cpu += cpuEnd - cpuStart;
+        ++cyclesRun;
+
+        if (ppu_->FrameReady())
+        {
+            FrameCompleted();
+            frameReady_ = true;
+            break;
+        }
+    }
+
+    return cyclesRun;
+}
+
 void NES::RunUntilFrameReady()
 {
     if (cartLoaded_)
@@ -112,6 +248,8 @@ void NES::RunUntilFrameReady()
             apu_->Clock();
             cpu_->Clock();
         }
+
+        FrameCompleted();
     }
 }
 
@@ -130,7 +268,137 @@ void NES::RunUntilSerializable()
 
 void NES::SetOverscan(bool enabled)
 {
-    ppu_->SetOverscan(enabled);
+    frameConverter_.SetOverscan(enabled);
+    ntscFilter_.SetOverscan(enabled);
+}
+
+void NES::SetInstructionStepping(bool enabled)
+{
+    instructionStepping_ = enabled;
+}
+
+void NES::SetIdleLoopSkipping(bool enabled)
+{
+    cpu_->SetIdleLoopSkipping(enabled);
+}
+
+bool NES::StartTrace(std::filesystem::path const tracePath)
+{
+    StopTrace();
+    trace_ = std::make_unique<CpuTrace>(tracePath);
+
+    if (!trace_->IsOpen())
+    {
+        trace_.reset();
+        return false;
+    }
+
+    cpu_->SetTrace(trace_.get());
+    return true;
+}
+
+void NES::StopTrace()
+{
+    cpu_->SetTrace(nullptr);
+    trace_.reset();
+}
+
+uint16_t const* NES::GetFrameBuffer()
+{
+    // Newest complete frame. Only the thread presenting frames may call this.
+    if (readyFrame_.load(std::memory_order_relaxed) & FRESH_FRAME)
+    {
+        frontFrame_ = readyFrame_.exchange(frontFrame_, std::memory_order_acq_rel) & FRAME_INDEX_MASK;
+    }
+
+    return frameBuffers_[frontFrame_].get();
+}
+
+uint16_t const* NES::GetLastFrame() const
+{
+    // Frame most recently completed by the PPU, for use on the emulation thread. It won't be drawn over again until two
+    // more frames have completed.
+    return frameBuffers_[lastFrame_].get();
+}
+
+void NES::ConvertFrame(uint16_t const* frame, uint8_t* pixels, size_t pitch, PixelFormat format) const
+{
+    // Safe to call from any thread
+    frameConverter_.Convert(frame, pixels, pitch, format);
+}
+
+uint8_t NES::GetFramePhase() const
+{
+    // Phase of the frame returned by the last GetFrameBuffer() call. Only the thread presenting frames may call this.
+    return framePhases_[frontFrame_];
+}
+
+void NES::FilterFrame(uint16_t const* frame, uint8_t phase, uint8_t* pixels, size_t pitch) const
+{
+    // Safe to call from any thread
+    ntscFilter_.Filter(frame, phase, pixels, pitch);
+}
+
+void NES::SetFrameSkip(FrameSkipMode mode, int frames)
+{
+    // Takes effect from the next frame the PPU starts
+    frameSkipMode_ = mode;
+    frameSkipCount_ = frames;
+}
+
+uint64_t NES::GetReusedFrameCount() const
+{
+    return reusedFrames_;
+}
+
+void NES::FrameCompleted()
+{
+    // Skipped and reused frames aren't swapped out, so the presenter and GetLastFrame() only ever see fully drawn ones.
+    // The choices are made here, during vblank, so the PPU never switches modes partway through a frame.
+    bool frameReused = ppu_->FrameReused();
+    bool lastFrameCurrent = frameReused || !frameSkipped_;
+
+    if (frameReused)
+    {
+        ++reusedFrames_;
+    }
+    else if (!frameSkipped_)
+    {
+        SwapFrameBuffers();
+    }
+
+    framesUnchanged_ = ppu_->FrameChanged() ? 0 : std::min(framesUnchanged_ + 1, REUSE_AFTER_UNCHANGED);
+
+    frameSkipped_ = SkipNextFrame();
+    framesSkipped_ = frameSkipped_ ? (framesSkipped_ + 1) : 0;
+    ppu_->SetFrameSkipped(frameSkipped_);
+
+    // The last frame drawn is only known to match after a frame that wasn't skipped
+    bool reuseFrame = !frameSkipped_ && lastFrameCurrent && (framesUnchanged_ >= REUSE_AFTER_UNCHANGED);
+    ppu_->SetReusedFrame(reuseFrame ? frameBuffers_[lastFrame_].get() : nullptr);
+}
+
+bool NES::SkipNextFrame()
+{
+    switch (frameSkipMode_.load(std::memory_order_relaxed))
+    {
+        case FrameSkipMode::FIXED:
+            return framesSkipped_ < frameSkipCount_.load(std::memory_order_relaxed);
+        case FrameSkipMode::ADAPTIVE:
+            // A frame the presenter hasn't taken yet means it's running behind the frame rate
+            return ((readyFrame_.load(std::memory_order_relaxed) & FRESH_FRAME) == FRESH_FRAME) &&
+                   (framesSkipped_ < MAX_ADAPTIVE_SKIP);
+        default:
+            return false;
+    }
+}
+
+void NES::SwapFrameBuffers()
+{
+    lastFrame_ = backFrame_;
+    framePhases_[backFrame_] = ppu_->FramePhase();
+    backFrame_ = readyFrame_.exchange(backFrame_ | FRESH_FRAME, std::memory_order_acq_rel) & FRAME_INDEX_MASK;
+    ppu_->SetFrameBuffer(frameBuffers_[backFrame_].get());
 }
 
 void NES::Serialize(std::ofstream& saveState)
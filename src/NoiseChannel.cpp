@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <limits>
 
 NoiseChannel::NoiseChannel()
 {
@@ -31,7 +32,7 @@ void NoiseChannel::Reset()
     timer_ = 0;
 }
 
-uint8_t NoiseChannel::GetOutput()
+uint8_t NoiseChannel::GetOutput() const
 {
     if (((shiftRegister_ & 0x01) == 0x01) || (lengthCounter_ == 0))
     {
@@ -56,15 +57,7 @@ void NoiseChannel::Clock()
     if (timer_ == 0)
     {
         timer_ = timerReload_;
-
-        uint16_t feedbackXorBit = mode_ ? ((shiftRegister_ & 0x0040) >> 6) : ((shiftRegister_ & 0x0002) >> 1);
-        bool feedback = ((shiftRegister_ & 0x01) ^ feedbackXorBit) == 0x0001;
-        shiftRegister_ >>= 1;
-
-        if (feedback)
-        {
-            shiftRegister_ |= 0x4000;
-        }
+        ClockShiftRegister();
     }
     else
     {
@@ -72,6 +65,31 @@ void NoiseChannel::Clock()
     }
 }
 
+void NoiseChannel::Run(int clocks)
+{
+    // Same as clocks calls to Clock()
+    while (clocks > timer_)
+    {
+        clocks -= timer_ + 1;
+        timer_ = timerReload_;
+        ClockShiftRegister();
+    }
+
+    timer_ -= clocks;
+}
+
+int NoiseChannel::ClocksUntilOutputChange() const
+{
+    uint8_t volume = useConstantVolume_ ? constantVolume_ : decayLevel_;
+
+    if ((lengthCounter_ == 0) || (volume == 0))
+    {
+        return std::numeric_limits<int>::max();
+    }
+
+    return timer_ + 1;
+}
+
 void NoiseChannel::HalfFrameClock()
 {
     QuarterFrameClock();
@@ -142,3 +160,15 @@ void NoiseChannel::Deserialize(std::ifstream& saveState)
 {
     saveState.read((char*)this, sizeof(NoiseChannel));
 }
+
+void NoiseChannel::ClockShiftRegister()
+{
+    uint16_t feedbackXorBit = mode_ ? ((shiftRegister_ & 0x0040) >> 6) : ((shiftRegister_ & 0x0002) >> 1);
+    bool feedback = ((shiftRegister_ & 0x01) ^ feedbackXorBit) == 0x0001;
+    shiftRegister_ >>= 1;
+
+    if (feedback)
+    {
+        shiftRegister_ |= 0x4000;
+    }
+}
@@ -0,0 +1,251 @@
+#include "../include/NtscFilter.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#define NTSC_FILTER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+// PPU output levels relative to sync: low and high for each of the four luma levels, then the same attenuated by color
+// emphasis.
+constexpr std::array<double, 16> SIGNAL_LEVELS = {0.228, 0.312, 0.552, 0.880,
+                                                  0.616, 0.840, 1.100, 1.100,
+                                                  0.192, 0.256, 0.448, 0.712,
+                                                  0.500, 0.676, 0.896, 0.896};
+
+constexpr double BLACK_LEVEL = 0.312;
+constexpr double WHITE_LEVEL = 1.100;
+
+// Decoder phase adjustment, in samples, so hues line up with the palette files
+constexpr double HUE_SHIFT = 3.9;
+
+constexpr double PI = 3.14159265358979323846;
+
+bool InColorPhase(int hue, int phase)
+{
+    return ((hue + phase) % 12) < 6;
+}
+}
+
+NtscFilter::NtscFilter() :
+    overscan_(false)
+{
+    // Output pixels are decoded from the subcarrier cycle of samples centered on them, 2 samples in from either edge of
+    // the pixel they belong to. Relative to a pixel's first sample, those centers fall at -2 for the pixel to the left,
+    // 2 and 6 for itself, and 10 for the pixel to the right.
+    constexpr std::array<int, 4> OUTPUT_CENTERS = {-2, 2, 6, 10};
+    constexpr double SCALE = 255.0 * (1 << FRACTION_BITS);
+    constexpr int16_t ROUNDING = 1 << (FRACTION_BITS - 1);
+    constexpr int16_t OPAQUE = 0xFF << FRACTION_BITS;
+
+    for (size_t phaseIndex = 0; phaseIndex < PHASE_COUNT; ++phaseIndex)
+    {
+        int firstPhase = phaseIndex * (SUBCARRIER_PERIOD / PHASE_COUNT);
+
+        for (size_t color = 0; color < COLOR_COUNT; ++color)
+        {
+            std::array<double, SAMPLES_PER_PIXEL> samples;
+
+            for (int sample = 0; sample < SAMPLES_PER_PIXEL; ++sample)
+            {
+                double level = Signal(color, (firstPhase + sample) % SUBCARRIER_PERIOD);
+                samples[sample] = (level - BLACK_LEVEL) / (WHITE_LEVEL - BLACK_LEVEL);
+            }
+
+            std::array<std::array<int16_t, 4>, 4> outputs;
+
+            for (size_t output = 0; output < OUTPUT_CENTERS.size(); ++output)
+            {
+                double y = 0.0;
+                double i = 0.0;
+                double q = 0.0;
+
+                for (int sample = 0; sample < SAMPLES_PER_PIXEL; ++sample)
+                {
+                    int offset = sample - OUTPUT_CENTERS[output];
+
+                    if ((offset < -(SUBCARRIER_PERIOD / 2)) || (offset >= (SUBCARRIER_PERIOD / 2)))
+                    {
+                        continue;
+                    }
+
+                    double level = samples[sample] / SUBCARRIER_PERIOD;
+                    double angle = PI * (firstPhase + sample + HUE_SHIFT) / (SUBCARRIER_PERIOD / 2);
+                    y += level;
+                    i += level * std::cos(angle);
+                    q += level * std::sin(angle);
+                }
+
+                double r = y + (0.946882 * i) + (0.623557 * q);
+                double g = y - (0.274788 * i) - (0.635691 * q);
+                double b = y - (1.108545 * i) + (1.709007 * q);
+
+                outputs[output] = {static_cast<int16_t>(std::lround(b * SCALE)),
+                                   static_cast<int16_t>(std::lround(g * SCALE)),
+                                   static_cast<int16_t>(std::lround(r * SCALE)),
+                                   0};
+            }
+
+            // Rounding and alpha go in once per output pixel, through the kernel of the pixel it belongs to
+            for (size_t output = 1; output <= 2; ++output)
+            {
+                for (size_t channel = 0; channel < 3; ++channel)
+                {
+                    outputs[output][channel] += ROUNDING;
+                }
+
+                outputs[output][3] = OPAQUE;
+            }
+
+            Kernel& kernel = kernels_[phaseIndex][color];
+            std::copy(outputs[1].begin(), outputs[1].end(), kernel.center.begin());
+            std::copy(outputs[2].begin(), outputs[2].end(), kernel.center.begin() + 4);
+            std::copy(outputs[0].begin(), outputs[0].end(), kernel.side.begin());
+            std::copy(outputs[3].begin(), outputs[3].end(), kernel.side.begin() + 4);
+        }
+    }
+}
+
+void NtscFilter::SetOverscan(bool enabled)
+{
+    overscan_ = enabled;
+}
+
+void NtscFilter::Filter(uint16_t const* frame, uint8_t phase, uint8_t* pixels, size_t pitch) const
+{
+    bool overscan = overscan_;
+
+    for (size_t row = 0; row < FRAME_HEIGHT; ++row)
+    {
+        if (overscan && ((row < OVERSCAN_TOP) || (row >= OVERSCAN_BOTTOM)))
+        {
+            ClearRow(pixels + (row * pitch));
+        }
+        else
+        {
+            // Pixel 0 is output on dot 1
+            size_t linePhase = (phase + (row * 4) + SAMPLES_PER_PIXEL) % SUBCARRIER_PERIOD;
+            size_t phaseIndex = linePhase / (SUBCARRIER_PERIOD / PHASE_COUNT);
+            FilterRow(frame + (row * FRAME_WIDTH), pixels + (row * pitch), phaseIndex);
+        }
+    }
+}
+
+void NtscFilter::FilterRow(uint16_t const* src, uint8_t* dst, size_t phase) const
+{
+    // Each pixel starts 8 samples after the last, which is 2 phases later
+    auto nextPhase = [](size_t phase) { return (phase == 0) ? 2 : (phase - 1); };
+    Kernel const* current = &GetKernel(phase, src[0]);
+
+#ifdef NTSC_FILTER_SSE2
+    __m128i leftSide = _mm_setzero_si128();
+
+    for (size_t x = 0; x < FRAME_WIDTH; ++x)
+    {
+        __m128i rightSide = _mm_setzero_si128();
+        Kernel const* next = nullptr;
+        phase = nextPhase(phase);
+
+        if (x + 1 < FRAME_WIDTH)
+        {
+            next = &GetKernel(phase, src[x + 1]);
+            rightSide = _mm_load_si128((__m128i const*)next->side.data());
+        }
+
+        // Right output pixel of the left neighbour's side, left output pixel of the right neighbour's side
+        __m128d sides = _mm_shuffle_pd(_mm_castsi128_pd(leftSide), _mm_castsi128_pd(rightSide), 1);
+        __m128i neighbors = _mm_castpd_si128(sides);
+        __m128i sum = _mm_add_epi16(_mm_load_si128((__m128i const*)current->center.data()), neighbors);
+        sum = _mm_srai_epi16(sum, FRACTION_BITS);
+        _mm_storel_epi64((__m128i*)(dst + (x * 8)), _mm_packus_epi16(sum, sum));
+
+        leftSide = _mm_load_si128((__m128i const*)current->side.data());
+        current = next;
+    }
+#else
+    std::array<int16_t, 4> leftSide {};
+
+    for (size_t x = 0; x < FRAME_WIDTH; ++x)
+    {
+        std::array<int16_t, 4> rightSide {};
+        Kernel const* next = nullptr;
+        phase = nextPhase(phase);
+
+        if (x + 1 < FRAME_WIDTH)
+        {
+            next = &GetKernel(phase, src[x + 1]);
+            std::copy(next->side.begin(), next->side.begin() + 4, rightSide.begin());
+        }
+
+        for (size_t channel = 0; channel < 4; ++channel)
+        {
+            int left = (current->center[channel] + leftSide[channel]) >> FRACTION_BITS;
+            int right = (current->center[channel + 4] + rightSide[channel]) >> FRACTION_BITS;
+            dst[(x * 8) + channel] = std::clamp(left, 0, 0xFF);
+            dst[(x * 8) + channel + 4] = std::clamp(right, 0, 0xFF);
+        }
+
+        std::copy(current->side.begin() + 4, current->side.end(), leftSide.begin());
+        current = next;
+    }
+#endif
+}
+
+void NtscFilter::ClearRow(uint8_t* dst) const
+{
+    constexpr std::array<uint8_t, 4> OPAQUE_BLACK = {0x00, 0x00, 0x00, 0xFF};
+
+    for (size_t x = 0; x < NTSC_FRAME_WIDTH; ++x)
+    {
+        std::memcpy(dst + (x * 4), OPAQUE_BLACK.data(), OPAQUE_BLACK.size());
+    }
+}
+
+double NtscFilter::Signal(uint16_t color, int phase)
+{
+    // Level of the signal for a pixel at one sample. Hues 1-12 alternate between the low and high levels of their luma
+    // for half a subcarrier cycle each, hue 0 stays high, and hues 13-15 stay low. Emphasis attenuates the signal
+    // during the half cycles of its color.
+    int hue = color & 0x0F;
+    int luma = (color >> 4) & 0x03;
+    int emphasis = (color >> PIXEL_EMPHASIS_SHIFT) & 0x07;
+
+    if (hue > 13)
+    {
+        luma = 1;
+    }
+
+    bool attenuated = (((emphasis & 0x01) != 0) && InColorPhase(0, phase)) ||
+                      (((emphasis & 0x02) != 0) && InColorPhase(4, phase)) ||
+                      (((emphasis & 0x04) != 0) && InColorPhase(8, phase));
+
+    int levels = attenuated ? 8 : 0;
+    double low = SIGNAL_LEVELS[levels + luma];
+    double high = SIGNAL_LEVELS[levels + 4 + luma];
+
+    if (hue == 0)
+    {
+        low = high;
+    }
+    else if (hue > 12)
+    {
+        high = low;
+    }
+
+    return InColorPhase(hue, phase) ? high : low;
+}
+
+NtscFilter::Kernel const& NtscFilter::GetKernel(size_t phase, uint16_t pixel) const
+{
+    // Grayscale keeps only the luma bits of the palette entry
+    uint16_t colorMask = ((pixel & PIXEL_GRAYSCALE) == PIXEL_GRAYSCALE) ? 0x01F0 : 0x01FF;
+    return kernels_[phase][pixel & colorMask];
+}
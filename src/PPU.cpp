@@ -1,23 +1,26 @@
 #include "../include/PPU.hpp"
 #include "../include/Cartridge.hpp"
+#include "../include/FrameConverter.hpp"
 #include "../include/RegisterAddresses.hpp"
 #include "../include/mappers/MMC3.hpp"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <utility>
 
-PPU::PPU(uint8_t* frameBuffer, std::ifstream& normalColors, std::ifstream& grayscaleColors) :
-    frameBuffer_(frameBuffer)
+PPU::PPU() :
+    cartridge_(nullptr),
+    frameBuffer_(nullptr),
+    reusedFrame_(nullptr)
 {
     Initialize();
-    InitializePalettes(normalColors, grayscaleColors);
 }
 
 void PPU::Reset()
 {
     // Palettes
-    paletteIndex_ = 0;
-    useGrayscale_ = false;
+    pixelAttributes_ = 0x0000;
 
     // Background fetch
     backgroundFetchCycle_ = 0x00;
@@ -79,13 +82,19 @@ void PPU::Reset()
     // Frame buffer
     frameReady_ = false;
     framePointer_ = 0;
+    framePhase_ = 0;
+    reusedFrame_ = nullptr;
+    lastFrameReused_ = false;
+    frameChanged_ = true;
 }
 
 void PPU::Initialize()
 {
+    // Nametables
+    SetNametablePages(MirrorType::QUAD);
+
     // Palettes
-    paletteIndex_ = 0;
-    useGrayscale_ = false;
+    pixelAttributes_ = 0x0000;
 
     // Background fetch
     backgroundFetchCycle_ = 0;
@@ -125,8 +134,14 @@ void PPU::Initialize()
         sprite.valid = false;
         sprite.patternTableLowByte = 0x00;
         sprite.patternTableHighByte = 0x00;
+        sprite.pixels = 0;
     }
 
+    // Sprite line buffer
+    spriteLine_.fill(0x00);
+    spritesOnLine_ = false;
+    sprite0OnLine_ = false;
+
     // Pixel retrieval
     backgroundPixelAddr_ = 0x3F00;
     spritePixelAddr_ = 0x3F00;
@@ -161,7 +176,11 @@ void PPU::Initialize()
     // Frame buffer
     frameReady_ = false;
     framePointer_ = 0;
-    overscan_ = false;
+    framePhase_ = 0;
+    frameSkipped_ = false;
+    reusedFrame_ = nullptr;
+    lastFrameReused_ = false;
+    frameChanged_ = true;
 
     // Initialize memory
     OAM_.fill(0xFF);
@@ -173,12 +192,6 @@ void PPU::Initialize()
     SetCartType();
 }
 
-void PPU::InitializePalettes(std::ifstream& normalColors, std::ifstream& grayscaleColors)
-{
-    normalColors.read((char*)NormalColors_.data(), NormalColors_.size() * NormalColors_[0].size() * sizeof(RGB));
-    grayscaleColors.read((char*)GrayscaleColors_.data(), GrayscaleColors_.size() * GrayscaleColors_[0].size() * sizeof(RGB));
-}
-
 void PPU::Clock()
 {
     if (runAhead_)
@@ -189,19 +202,284 @@ void PPU::Clock()
 
     for (int i = 0; i < 3; ++i)
     {
-        renderingEnabled_ = RenderingEnabled();
+        ClockDot();
+    }
+}
+
+void PPU::Run(size_t cycles)
+{
+    // Same as calling Clock() the given number of times. Nothing outside the PPU can touch its registers, OAM, or the
+    // cartridge's CHR and mirroring state until this returns, so visible dots are rendered a tile at a time whenever the
+    // background fetches are at a tile boundary and the whole tile falls within the remaining dots. Everything else,
+    // including partial tiles at either end, goes through the dot by dot path. Likewise, a line's sprite evaluation is
+    // done all at once when the remaining dots cover the rest of it, otherwise it's stepped a dot at a time. Stretches of
+    // dots with nothing to do are skipped over.
+    if (cycles == 0)
+    {
+        return;
+    }
+
+    if (runAhead_)
+    {
+        runAhead_ = false;
+        --cycles;
+    }
+
+    size_t dots = cycles * 3;
+
+    while (dots > 0)
+    {
+        uint8_t lineType = LINE_TYPES[scanline_];
+
+        if (lineType <= LAST_VISIBLE_LINE)
+        {
+            if ((dot_ >= 1) && (dot_ <= 64) && (dots > 255 - dot_) &&
+                (spriteState_ == SpriteEvalState::READ) && (oamIndex_ == 0) && (oamOffset_ == 0))
+            {
+                EvaluateSprites();
+            }
+
+            if ((dots >= 8) && (dot_ >= 1) && (dot_ <= 248) && (backgroundFetchCycle_ == 0))
+            {
+                RenderTile();
+                dots -= 8;
+                continue;
+            }
+        }
+        else if (IDLE_DOTS[lineType][dot_] != 0)
+        {
+            size_t idleDots = std::min<size_t>(IDLE_DOTS[lineType][dot_], dots);
+            renderingEnabled_ = RenderingEnabled();
+            dot_ += idleDots;
+            dots -= idleDots;
+            continue;
+        }
+
+        ClockDot();
+        --dots;
+    }
+}
+
+constexpr std::array<uint8_t, 262> PPU::CreateLineTypeTable()
+{
+    std::array<uint8_t, 262> table {};
+
+    for (size_t scanline = 0; scanline < table.size(); ++scanline)
+    {
+        if (scanline < 239)
+        {
+            table[scanline] = VISIBLE_LINE;
+        }
+        else if (scanline == 239)
+        {
+            table[scanline] = LAST_VISIBLE_LINE;
+        }
+        else if (scanline == 241)
+        {
+            table[scanline] = VBLANK_START_LINE;
+        }
+        else if (scanline == 260)
+        {
+            table[scanline] = VBLANK_END_LINE;
+        }
+        else if (scanline == 261)
+        {
+            table[scanline] = PRE_RENDER_LINE;
+        }
+        else
+        {
+            table[scanline] = IDLE_LINE;
+        }
+    }
+
+    return table;
+}
+
+constexpr PPU::DotTable PPU::CreateDotTable()
+{
+    DotTable table {};
+
+    for (size_t dot = 0; dot < 341; ++dot)
+    {
+        uint16_t& visible = table[VISIBLE_LINE][dot];
+        uint16_t& preRender = table[PRE_RENDER_LINE][dot];
+
+        if (dot == 0)
+        {
+            visible = RESET_SPRITE_EVALUATION | EVEN_FRAME_NAMETABLE_READ | RENDER_PIXEL;
+            preRender = RESET_SPRITE_EVALUATION | CLEAR_VBLANK;
+        }
+        else if (dot <= 256)
+        {
+            visible = BACKGROUND_FETCH;
+            preRender = BACKGROUND_FETCH;
+
+            if ((dot >= 64) && (dot <= 255))
+            {
+                visible |= SPRITE_EVALUATION;
+            }
+
+            if (dot <= 255)
+            {
+                visible |= RENDER_PIXEL;
+            }
+        }
+        else if (dot <= 320)
+        {
+            visible = SPRITE_FETCH;
+            preRender = SPRITE_FETCH;
+
+            if (dot == 257)
+            {
+                visible |= TRANSFER_HORIZONTAL;
+                preRender |= TRANSFER_HORIZONTAL;
+            }
+            else if ((dot >= 280) && (dot <= 304))
+            {
+                preRender |= TRANSFER_VERTICAL;
+            }
+        }
+        else if (dot <= 336)
+        {
+            visible = BACKGROUND_FETCH;
+            preRender = BACKGROUND_FETCH;
+        }
+        else if ((dot % 2) == 0)
+        {
+            visible = RENDERING_NAMETABLE_READ;
+            preRender = NAMETABLE_READ;
+        }
+    }
+
+    table[LAST_VISIBLE_LINE] = table[VISIBLE_LINE];
+    table[LAST_VISIBLE_LINE][256] |= FRAME_READY;
+    table[VBLANK_START_LINE][0] = SET_VBLANK;
+    table[VBLANK_END_LINE][340] = CLEAR_SPRITE_FLAGS;
+    return table;
+}
+
+constexpr PPU::DotTable PPU::CreateIdleDotTable()
+{
+    // Dots in a row with no actions, stopping short of the last dot of the line so DotIncrement() still handles moving to
+    // the next line. The pre-render line is left out since its line length depends on rendering and the frame.
+    DotTable table {};
+    DotTable actions = CreateDotTable();
+
+    for (size_t lineType = 0; lineType < LINE_TYPE_COUNT; ++lineType)
+    {
+        if (lineType == PRE_RENDER_LINE)
+        {
+            continue;
+        }
+
+        for (int dot = 339; dot >= 0; --dot)
+        {
+            if (actions[lineType][dot] == 0)
+            {
+                table[lineType][dot] = table[lineType][dot + 1] + 1;
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr std::array<uint8_t, 262> PPU::LINE_TYPES = PPU::CreateLineTypeTable();
+constexpr PPU::DotTable PPU::DOT_ACTIONS = PPU::CreateDotTable();
+constexpr PPU::DotTable PPU::IDLE_DOTS = PPU::CreateIdleDotTable();
+
+void PPU::ClockDot()
+{
+    renderingEnabled_ = RenderingEnabled();
+    uint16_t actions = DOT_ACTIONS[LINE_TYPES[scanline_]][dot_];
+
+    if (actions != 0)
+    {
+        RunDotActions(actions);
+    }
+
+    DotIncrement();
+}
+
+void PPU::RunDotActions(uint16_t actions)
+{
+    // Most dots only fetch, evaluate, and render, so the rarer actions are grouped behind a single test on each side
+    if ((actions & LINE_START_ACTIONS) != 0)
+    {
+        if ((actions & RESET_SPRITE_EVALUATION) != 0)
+        {
+            ResetSpriteEvaluation();
+        }
+
+        if ((actions & CLEAR_VBLANK) != 0)
+        {
+            MemMappedRegisters_.PPUSTATUS &= ~(VBLANK_STARTED_MASK);
+            suppressVblFlag_ = false;
+        }
+
+        if (((actions & NAMETABLE_READ) != 0) ||
+            (((actions & RENDERING_NAMETABLE_READ) != 0) && renderingEnabled_) ||
+            (((actions & EVEN_FRAME_NAMETABLE_READ) != 0) && renderingEnabled_ && !oddFrame_))
+        {
+            Read(0x2000 | (InternalRegisters_.v & 0x0FFF));
+        }
+    }
+
+    if ((actions & BACKGROUND_FETCH) != 0)
+    {
+        BackgroundFetch();
+    }
+
+    if ((actions & SPRITE_EVALUATION) != 0)
+    {
+        SpriteEvaluation();
+    }
 
-        if (scanline_ < 240)
+    if ((actions & RENDER_PIXEL) != 0)
+    {
+        if (PixelsNeeded())
+        {
+            CreateBackgroundPixel();
+            CreateSpritePixel();
+            RenderPixel();
+        }
+        else
         {
-            VisibleLine();
+            ++framePointer_;
+        }
+    }
 
-            if ((scanline_ == 239) && (dot_ == 256))
+    if ((actions & SPRITE_FETCH) != 0)
+    {
+        if ((actions & TRANSFER_HORIZONTAL) != 0)
+        {
+            if (renderingEnabled_)
             {
-                frameReady_ = true;
-                framePointer_ = 0;
+                TransferHorizontalPosition();
             }
+
+            oamSecondaryIndex_ = 0;
+        }
+
+        if (((actions & TRANSFER_VERTICAL) != 0) && renderingEnabled_)
+        {
+            TransferVerticalPosition();
         }
-        else if ((scanline_ == 241) && (dot_ == 0))
+
+        SpriteFetch();
+    }
+
+    if ((actions & LINE_END_ACTIONS) != 0)
+    {
+        if ((actions & FRAME_READY) != 0)
+        {
+            frameReady_ = true;
+            framePointer_ = 0;
+            lastFrameReused_ = (reusedFrame_ != nullptr);
+            reusedFrame_ = nullptr;
+        }
+
+        if ((actions & SET_VBLANK) != 0)
         {
             if (!suppressVblFlag_)
             {
@@ -211,16 +489,11 @@ void PPU::Clock()
 
             suppressVblFlag_ = false;
         }
-        else if ((scanline_ == 260) && (dot_ == 340))
+
+        if ((actions & CLEAR_SPRITE_FLAGS) != 0)
         {
             MemMappedRegisters_.PPUSTATUS &= ~(SPRITE_0_HIT_MASK | SPRITE_OVERFLOW_MASK);
         }
-        else if (scanline_ == 261)
-        {
-            PreRenderLine();
-        }
-
-        DotIncrement();
     }
 }
 
@@ -235,6 +508,11 @@ bool PPU::FrameReady()
     return false;
 }
 
+uint8_t PPU::FramePhase() const
+{
+    return framePhase_;
+}
+
 uint8_t PPU::ReadReg(uint16_t addr)
 {
     if (addr > 0x2007)
@@ -288,6 +566,11 @@ uint8_t PPU::ReadReg(uint16_t addr)
                 mmc3Cart_->ReadCHR(InternalRegisters_.v);
             }
 
+            if (VramAddressInUse())
+            {
+                SetFrameChanged();
+            }
+
             if (RenderingEnabled() && scanline_ < 240)
             {
                 CoarseXIncrement();
@@ -316,11 +599,22 @@ void PPU::WriteReg(uint16_t addr, uint8_t data)
 
     openBus_ = data;
 
+    // Scroll position is all in t and x until it's copied into v
+    uint16_t const previousT = InternalRegisters_.t;
+    uint8_t const previousX = InternalRegisters_.x;
+
     switch (addr)
     {
         case PPUCTRL_ADDR:
         {
             RunAhead();
+            uint8_t const pixelBits = SPRITE_PT_ADDRESS_MASK | BACKGROUND_PT_ADDRESS_MASK | SPRITE_SIZE_MASK;
+
+            if (((MemMappedRegisters_.PPUCTRL ^ data) & pixelBits) != 0x00)
+            {
+                SetFrameChanged();
+            }
+
             bool nmiEnabledBefore = ((MemMappedRegisters_.PPUCTRL & GENERATE_NMI_MASK) == GENERATE_NMI_MASK);
             MemMappedRegisters_.PPUCTRL = data;
             bool nmiEnabledAfter = ((MemMappedRegisters_.PPUCTRL & GENERATE_NMI_MASK) == GENERATE_NMI_MASK);
@@ -351,14 +645,23 @@ void PPU::WriteReg(uint16_t addr, uint8_t data)
             break;
         }
         case PPUMASK_ADDR:
+            if (data != MemMappedRegisters_.PPUMASK)
+            {
+                SetFrameChanged();
+            }
+
             MemMappedRegisters_.PPUMASK = data;
-            useGrayscale_ = (data & GRAYSCALE_MASK) == GRAYSCALE_MASK;
-            paletteIndex_ = (data & COLOR_EMPHASIS_MASK) >> 5;
+            SetPixelAttributes();
             break;
         case OAMADDR_ADDR:
             MemMappedRegisters_.OAMADDR = data;
             break;
         case OAMDATA_ADDR:
+            if (data != OAM_[MemMappedRegisters_.OAMADDR])
+            {
+                SetFrameChanged();
+            }
+
             OAM_[MemMappedRegisters_.OAMADDR] = data;
             ++MemMappedRegisters_.OAMADDR;
             break;
@@ -385,6 +688,11 @@ void PPU::WriteReg(uint16_t addr, uint8_t data)
                 InternalRegisters_.v = InternalRegisters_.t;
                 InternalRegisters_.w = false;
 
+                if (VramAddressInUse())
+                {
+                    SetFrameChanged();
+                }
+
                 if (mmc3Cart_)
                 {
                     mmc3Cart_->ReadCHR(InternalRegisters_.v);
@@ -405,11 +713,21 @@ void PPU::WriteReg(uint16_t addr, uint8_t data)
                 mmc3Cart_->ReadCHR(InternalRegisters_.v);
             }
 
+            if (VramAddressInUse())
+            {
+                SetFrameChanged();
+            }
+
             IncrementVRAMAddr();
             break;
         default:
             break;
     }
+
+    if ((InternalRegisters_.t != previousT) || (InternalRegisters_.x != previousX))
+    {
+        SetFrameChanged();
+    }
 }
 
 bool PPU::NMI()
@@ -437,15 +755,141 @@ std::pair<uint16_t, uint16_t> PPU::GetState()
     return std::make_pair(scanline_, dot_);
 }
 
+size_t PPU::CyclesUntilEvent()
+{
+    // CPU cycles that can run before the PPU reaches the end of the visible frame, the start of vblank, or could clock the
+    // cartridge into asserting IRQ. NMI() depends on the exact dot for the first few dots of vblank, so nothing may run
+    // unsynchronized there. The skipped dot on odd frames can bring any event one dot closer, and CHR reads happen at
+    // most once per dot.
+    constexpr size_t DOTS_PER_SCANLINE = 341;
+    constexpr size_t DOTS_PER_FRAME = 262 * DOTS_PER_SCANLINE;
+    constexpr size_t FRAME_READY_DOT = (239 * DOTS_PER_SCANLINE) + 256;
+    constexpr size_t VBLANK_DOT = 241 * DOTS_PER_SCANLINE;
+
+    size_t currentDot = (scanline_ * DOTS_PER_SCANLINE) + dot_;
+
+    if ((currentDot >= VBLANK_DOT) && (currentDot <= VBLANK_DOT + 2))
+    {
+        return 0;
+    }
+
+    size_t dotsUntilFrameReady = (FRAME_READY_DOT + DOTS_PER_FRAME - currentDot) % DOTS_PER_FRAME;
+    size_t dotsUntilVblank = (VBLANK_DOT + DOTS_PER_FRAME - currentDot) % DOTS_PER_FRAME;
+    size_t dotsUntilIrq = cartridge_->ChrReadsUntilIrq() - 1;
+    size_t dots = std::min({dotsUntilFrameReady, dotsUntilVblank, dotsUntilIrq});
+    return (dots == 0) ? 0 : ((dots - 1) / 3);
+}
+
+size_t PPU::CyclesUntilStatusChange()
+{
+    // CPU cycles that can run before a PPUSTATUS read could return something different, assuming no PPU registers are
+    // accessed in between. Besides vblank starting and the flags being cleared before the pre-render line, rendering can
+    // set sprite 0 hit on the lines following the one sprite 0 is evaluated on, and sprite overflow on any line that
+    // evaluates at least eight sprites. Both are cut off at the start of the first line that could set them, which once
+    // this frame's visible lines are over is a line of the next frame, with both flags cleared by then.
+    constexpr size_t DOTS_PER_SCANLINE = 341;
+    constexpr size_t DOTS_PER_FRAME = 262 * DOTS_PER_SCANLINE;
+    constexpr size_t VBLANK_DOT = 241 * DOTS_PER_SCANLINE;
+    constexpr size_t FLAGS_CLEAR_DOT = (260 * DOTS_PER_SCANLINE) + 340;
+    constexpr size_t VBLANK_CLEAR_DOT = 261 * DOTS_PER_SCANLINE;
+
+    size_t currentDot = (scanline_ * DOTS_PER_SCANLINE) + dot_;
+    size_t dots = std::min({(VBLANK_DOT + DOTS_PER_FRAME - currentDot) % DOTS_PER_FRAME,
+                            (FLAGS_CLEAR_DOT + DOTS_PER_FRAME - currentDot) % DOTS_PER_FRAME,
+                            (VBLANK_CLEAR_DOT + DOTS_PER_FRAME - currentDot) % DOTS_PER_FRAME});
+
+    if (RenderingEnabled())
+    {
+        bool nextFrame = (scanline_ >= 240);
+        size_t fromLine = nextFrame ? 0 : scanline_;
+        size_t spriteHeight = ((MemMappedRegisters_.PPUCTRL & SPRITE_SIZE_MASK) == SPRITE_SIZE_MASK) ? 16 : 8;
+        size_t firstLine = 240;
+
+        if (nextFrame || ((MemMappedRegisters_.PPUSTATUS & SPRITE_0_HIT_MASK) == 0x00))
+        {
+            size_t sprite0Line = OAM_[0];
+
+            if (sprite0Line + spriteHeight >= fromLine)
+            {
+                firstLine = sprite0Line;
+            }
+        }
+
+        if (nextFrame || ((MemMappedRegisters_.PPUSTATUS & SPRITE_OVERFLOW_MASK) == 0x00))
+        {
+            std::array<uint8_t, 256 + 16> spritesOnLine{};
+
+            for (size_t sprite = 0; sprite < 64; ++sprite)
+            {
+                for (size_t line = OAM_[sprite * 4]; line < OAM_[sprite * 4] + spriteHeight; ++line)
+                {
+                    ++spritesOnLine[line];
+                }
+            }
+
+            for (size_t line = fromLine; line < firstLine; ++line)
+            {
+                if (spritesOnLine[line] >= 8)
+                {
+                    firstLine = line;
+                    break;
+                }
+            }
+        }
+
+        if (!nextFrame && (firstLine <= scanline_))
+        {
+            return 0;
+        }
+        else if (firstLine < 240)
+        {
+            size_t lines = (firstLine + 262 - scanline_) % 262;
+            dots = std::min(dots, (lines * DOTS_PER_SCANLINE) - dot_);
+        }
+    }
+
+    return (dots == 0) ? 0 : ((dots - 1) / 3);
+}
+
 void PPU::LoadCartridge(Cartridge* cartridge)
 {
     cartridge_ = cartridge;
+    cartridge_->SetMirroringCallback([this](MirrorType mirrorType) { SetNametablePages(mirrorType); });
+    cartridge_->SetChrBanksCallback([this]() { SetFrameChanged(); });
     SetCartType();
 }
 
-void PPU::SetOverscan(bool enabled)
+void PPU::SetFrameBuffer(uint16_t* frameBuffer)
 {
-    overscan_ = enabled;
+    frameBuffer_ = frameBuffer;
+}
+
+void PPU::SetFrameSkipped(bool skipped)
+{
+    frameSkipped_ = skipped;
+}
+
+void PPU::SetReusedFrame(uint16_t const* frame)
+{
+    // Frame the one about to start is identical to if nothing changes, or nullptr to draw it
+    reusedFrame_ = frame;
+}
+
+bool PPU::FrameReused() const
+{
+    // Whether the last frame completed was reused in full, leaving nothing in the frame buffer
+    return lastFrameReused_;
+}
+
+bool PPU::FrameChanged()
+{
+    if (frameChanged_)
+    {
+        frameChanged_ = false;
+        return true;
+    }
+
+    return false;
 }
 
 uint8_t PPU::Read(uint16_t addr)
@@ -456,7 +900,7 @@ uint8_t PPU::Read(uint16_t addr)
     }
     else if (addr < 0x3F00)
     {
-        return VRAM_[NameTableAddress(addr)];
+        return Nametable(addr);
     }
     else
     {
@@ -468,14 +912,21 @@ void PPU::Write(uint16_t addr, uint8_t data)
 {
     if (addr < 0x2000)
     {
+        // Reading CHR back to compare could clock the mapper
+        SetFrameChanged();
         cartridge_->WriteCHR(addr, data);
     }
     else if (addr < 0x3F00)
     {
-        VRAM_[NameTableAddress(addr)] = data;
+        if (Nametable(addr) != data)
+        {
+            SetFrameChanged();
+            Nametable(addr) = data;
+        }
     }
-    else
+    else if (PaletteRAM_[PaletteAddress(addr)] != data)
     {
+        SetFrameChanged();
         PaletteRAM_[PaletteAddress(addr)] = data;
     }
 }
@@ -485,6 +936,12 @@ bool PPU::RenderingEnabled()
     return (MemMappedRegisters_.PPUMASK & (SHOW_BACKGROUND_MASK | SHOW_SPRITES_MASK)) != 0x00;
 }
 
+bool PPU::VramAddressInUse()
+{
+    // Outside of rendering, v is reloaded from t before any tiles are fetched with it
+    return RenderingEnabled() && ((scanline_ < 240) || (scanline_ == 261));
+}
+
 void PPU::SetNMI()
 {
     nmiCpuCheck_ = ((MemMappedRegisters_.PPUCTRL & GENERATE_NMI_MASK) == GENERATE_NMI_MASK) &&
@@ -497,104 +954,65 @@ void PPU::RunAhead()
     runAhead_ = true;;
 }
 
-void PPU::PreRenderLine()
+void PPU::RenderTile()
 {
-    switch (dot_)
+    // Equivalent to eight visible line dots starting where the background fetches begin a new tile, somewhere in dots
+    // 1 through 248. Background pixels come straight from the shift registers as they were before the tile, each dot
+    // being shifted one more bit, with the attribute latches filling in from the right. The tile's fetches are then done
+    // in their usual order, so CHR reads the cartridge sees are unchanged.
+    renderingEnabled_ = RenderingEnabled();
+
+    bool pixelsNeeded = PixelsNeeded();
+    uint64_t backgroundPixels = pixelsNeeded ? CreateBackgroundPixels() : 0;
+
+    patternTableShifterHigh_ <<= 8;
+    patternTableShifterLow_ <<= 8;
+    attributeTableShifterHigh_ = attributeTableLatchHigh_ ? 0xFF : 0x00;
+    attributeTableShifterLow_ = attributeTableLatchLow_ ? 0xFF : 0x00;
+
+    FetchNametableByte();
+    FetchAttributeTableByte();
+    FetchPatternTableLowByte();
+    FetchPatternTableHighByte();
+
+    if (!pixelsNeeded)
     {
-        case 0:
-            ResetSpriteEvaluation();
-            MemMappedRegisters_.PPUSTATUS &= ~(VBLANK_STARTED_MASK);
-            suppressVblFlag_ = false;
-            break;
-        case 1:
-            BackgroundFetch();
-            break;
-        case 2 ... 256:
-            BackgroundFetch();
-            break;
-        case 257:
-            if (renderingEnabled_)
-            {
-                TransferHorizontalPosition();
-            }
-            oamSecondaryIndex_ = 0;
-            SpriteFetch();
-            break;
-        case 258 ... 279:
-            SpriteFetch();
-            break;
-        case 280 ... 304:
-            if (renderingEnabled_)
-            {
-                TransferVerticalPosition();
-            }
-            SpriteFetch();
-            break;
-        case 305 ... 320:
-            SpriteFetch();
-            break;
-        case 321 ... 336:
-            BackgroundFetch();
-            break;
-        case 337 ... 340:
-            if ((dot_ % 2) == 0)
+        for (int i = 0; i < 8; ++i)
+        {
+            if (dot_ >= 64)
             {
-                Read(0x2000 | (InternalRegisters_.v & 0x0FFF));
+                SpriteEvaluation();
             }
-            break;
+
+            ++dot_;
+        }
+
+        framePointer_ += 8;
+        return;
     }
-}
 
-void PPU::VisibleLine()
-{
-    switch (dot_)
+    bool spritesOnLine = spritesOnLine_ && (scanline_ != 0);
+
+    for (int i = 0; i < 8; ++i)
     {
-        case 0:
-            ResetSpriteEvaluation();
-            if (!oddFrame_ && renderingEnabled_)
-            {
-                Read(0x2000 | (InternalRegisters_.v & 0x0FFF));
-            }
-            CreateBackgroundPixel();
-            CreateSpritePixel();
-            RenderPixel();
-            break;
-        case 1 ... 63:
-            BackgroundFetch();
-            CreateBackgroundPixel();
-            CreateSpritePixel();
-            RenderPixel();
-            break;
-        case 64 ... 255:
-            BackgroundFetch();
+        if (dot_ >= 64)
+        {
             SpriteEvaluation();
-            CreateBackgroundPixel();
+        }
+
+        backgroundPixelAddr_ = 0x3F00 | ((backgroundPixels >> (i * 8)) & 0x0F);
+
+        if (spritesOnLine)
+        {
             CreateSpritePixel();
-            RenderPixel();
-            break;
-        case 256:
-            BackgroundFetch();
-            break;
-        case 257:
-            if (renderingEnabled_)
-            {
-                TransferHorizontalPosition();
-            }
-            oamSecondaryIndex_ = 0;
-            SpriteFetch();
-            break;
-        case 258 ... 320:
-            SpriteFetch();
-            break;
-        case 321 ... 336:
-            BackgroundFetch();
-            break;
-        case 337 ... 340:
-            if (renderingEnabled_ && ((dot_ % 2) == 0))
-            {
-                Read(0x2000 | (InternalRegisters_.v & 0x0FFF));
-            }
-            break;
+        }
+        else
+        {
+            spritePixelAddr_ = 0x3F10;
+        }
+
+        RenderPixel();
+        ++dot_;
     }
 }
 
@@ -671,6 +1089,7 @@ void PPU::DotIncrement()
             dot_ = 0;
             scanline_ = 0;
             oddFrame_ = !oddFrame_;
+            framePhase_ = (framePhase_ + 8) % 12;
         }
         else
         {
@@ -686,6 +1105,7 @@ void PPU::DotIncrement()
         {
             scanline_ = 0;
             oddFrame_ = !oddFrame_;
+            framePhase_ = (framePhase_ + 4) % 12;
         }
     }
 }
@@ -722,66 +1142,74 @@ void PPU::BackgroundFetch()
     ShiftRegisters();
     ++backgroundFetchCycle_;
 
+    switch (backgroundFetchCycle_)
+    {
+        case 2:
+            FetchNametableByte();
+            break;
+        case 4:
+            FetchAttributeTableByte();
+            break;
+        case 6:
+            FetchPatternTableLowByte();
+            break;
+        case 8:
+            FetchPatternTableHighByte();
+            backgroundFetchCycle_ = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+void PPU::FetchNametableByte()
+{
     if (renderingEnabled_)
     {
-        switch (backgroundFetchCycle_)
-        {
-            case 2:
-                nametableByte_ = Read(0x2000 | (InternalRegisters_.v & 0x0FFF));
-                break;
-            case 4:
-                attributeTableByte_ = Read(0x23C0 |
+        nametableByte_ = Nametable(InternalRegisters_.v);
+    }
+    else
+    {
+        nametableByte_ = 0x00;
+    }
+}
+
+void PPU::FetchAttributeTableByte()
+{
+    if (renderingEnabled_)
+    {
+        attributeTableByte_ = Nametable(0x23C0 |
                                         (InternalRegisters_.v & 0x0C00) |
                                         ((InternalRegisters_.v >> 4) & 0x0038) |
                                         ((InternalRegisters_.v >> 2) & 0x0007));
-                break;
-            case 6:
-                patternTableAddress_ = ((MemMappedRegisters_.PPUCTRL & BACKGROUND_PT_ADDRESS_MASK) << 8) |
-                                        (nametableByte_ << 4) |
-                                        ((InternalRegisters_.v & 0x7000) >> 12);
-                patternTableLowByte_ = Read(patternTableAddress_);
-                break;
-            case 8:
-                patternTableAddress_ |= 0x0008;
-                patternTableHighByte_ = Read(patternTableAddress_);
-                LoadShiftRegisters();
-                CoarseXIncrement();
-
-                if (dot_ == 256)
-                {
-                    YIncrement();
-                }
-
-                backgroundFetchCycle_ = 0;
-                break;
-            default:
-                break;
-        }
     }
     else
     {
-        switch (backgroundFetchCycle_)
+        attributeTableByte_ = 0x00;
+    }
+}
+
+void PPU::FetchPatternTableLowByte()
+{
+    patternTableAddress_ = ((MemMappedRegisters_.PPUCTRL & BACKGROUND_PT_ADDRESS_MASK) << 8) |
+                            (nametableByte_ << 4) |
+                            ((InternalRegisters_.v & 0x7000) >> 12);
+    patternTableLowByte_ = Read(patternTableAddress_);
+}
+
+void PPU::FetchPatternTableHighByte()
+{
+    patternTableAddress_ |= 0x0008;
+    patternTableHighByte_ = Read(patternTableAddress_);
+    LoadShiftRegisters();
+
+    if (renderingEnabled_)
+    {
+        CoarseXIncrement();
+
+        if (dot_ == 256)
         {
-            case 2:
-                nametableByte_ = 0x00;
-                break;
-            case 4:
-                attributeTableByte_ = 0x00;
-                break;
-            case 6:
-                patternTableAddress_ = ((MemMappedRegisters_.PPUCTRL & BACKGROUND_PT_ADDRESS_MASK) << 8) |
-                                        (nametableByte_ << 4) |
-                                        ((InternalRegisters_.v & 0x7000) >> 12);
-                patternTableLowByte_ = Read(patternTableAddress_);
-                break;
-            case 8:
-                patternTableAddress_ |= 0x0008;
-                patternTableHighByte_ = Read(patternTableAddress_);
-                LoadShiftRegisters();
-                backgroundFetchCycle_ = 0;
-                break;
-            default:
-                break;
+            YIncrement();
         }
     }
 }
@@ -828,35 +1256,38 @@ void PPU::ShiftRegisters()
     attributeTableShifterLow_ |= (attributeTableLatchLow_ ? 0x01 : 0x00);
 }
 
-uint16_t PPU::NameTableAddress(uint16_t addr)
+void PPU::SetNametablePages(MirrorType mirrorType)
 {
-    addr &= 0x3FFF;
-
-    if (addr > 0x2FFF)
-    {
-        addr -= 0x1000;
-    }
+    std::array<size_t, 4> pages;
 
-    switch (cartridge_->GetMirrorType())
+    switch (mirrorType)
     {
         case MirrorType::HORIZONTAL:
-            addr = (addr - 0x2000) - (addr / 0x2400 * 0x0400) - (addr / 0x2C00 * 0x0400);
+            pages = {0, 0, 1, 1};
             break;
         case MirrorType::VERTICAL:
-            addr = (addr - 0x2000) - (addr / 0x2800 * 0x0800);
+            pages = {0, 1, 0, 1};
             break;
         case MirrorType::SINGLE_LOW:
-            addr %= 0x0400;
+            pages = {0, 0, 0, 0};
             break;
         case MirrorType::SINGLE_HIGH:
-            addr = 0x0400 | (addr % 0x0400);
+            pages = {1, 1, 1, 1};
             break;
         case MirrorType::QUAD:
-            addr -= 0x2000;
+        default:
+            pages = {0, 1, 2, 3};
             break;
     }
 
-    return addr;
+    for (size_t i = 0; i < nametablePages_.size(); ++i)
+    {
+        if (nametablePages_[i] != &VRAM_[pages[i] * 0x0400])
+        {
+            nametablePages_[i] = &VRAM_[pages[i] * 0x0400];
+            SetFrameChanged();
+        }
+    }
 }
 
 void PPU::ResetSpriteEvaluation()
@@ -987,6 +1418,64 @@ void PPU::SpriteEvaluation()
     }
 }
 
+void PPU::EvaluateSprites()
+{
+    // Everything SpriteEvaluation() does over dots 64 through 255, done at once. Evaluation always finishes before dot
+    // 256, and nothing can read the partial results or change OAM, PPUCTRL, or PPUMASK along the way, so the end state
+    // is the same. That includes the hardware bug where, once eight sprites are found, the OAM byte offset is incremented
+    // along with the sprite index while looking for a ninth.
+    int16_t spriteHeight = ((MemMappedRegisters_.PPUCTRL & SPRITE_SIZE_MASK) == SPRITE_SIZE_MASK) ? 16 : 8;
+
+    auto onLine = [&](uint8_t y)
+    {
+        int16_t yOffset = scanline_ - y;
+        return (yOffset >= 0) && (yOffset < spriteHeight);
+    };
+
+    while ((oamIndex_ < 64) && (spritesFound_ < 8))
+    {
+        oamByte_ = OAM_[oamIndex_ * 4];
+        OAM_Secondary_[oamSecondaryIndex_] = oamByte_;
+
+        if (onLine(oamByte_))
+        {
+            sprite0Loaded_ = sprite0Loaded_ || (oamIndex_ == 0);
+            ++oamSecondaryIndex_;
+
+            for (oamOffset_ = 1; oamOffset_ < 4; ++oamOffset_)
+            {
+                oamByte_ = OAM_[(oamIndex_ * 4) + oamOffset_];
+                OAM_Secondary_[oamSecondaryIndex_++] = oamByte_;
+            }
+
+            oamOffset_ = 0;
+            ++spritesFound_;
+        }
+
+        ++oamIndex_;
+    }
+
+    while (oamIndex_ < 64)
+    {
+        oamByte_ = OAM_[(oamIndex_ * 4) + oamOffset_];
+
+        if (onLine(oamByte_))
+        {
+            if (RenderingEnabled())
+            {
+                MemMappedRegisters_.PPUSTATUS |= SPRITE_OVERFLOW_MASK;
+            }
+
+            break;
+        }
+
+        ++oamIndex_;
+        oamOffset_ = (oamOffset_ + 1) % 4;
+    }
+
+    spriteState_ = SpriteEvalState::FINISHED;
+}
+
 void PPU::SpriteFetch()
 {
     ++spriteFetchCycle_;
@@ -1063,6 +1552,9 @@ void PPU::SpriteFetch()
         {
             patternTableAddress_ |= 0x08;
             Sprites_[spriteIndex_].patternTableHighByte = Read(patternTableAddress_);
+            Sprites_[spriteIndex_].pixels = DecodePatternRow(Sprites_[spriteIndex_].patternTableLowByte,
+                                                             Sprites_[spriteIndex_].patternTableHighByte,
+                                                             (Sprites_[spriteIndex_].attributes & FLIP_HORIZONTAL_MASK) == FLIP_HORIZONTAL_MASK);
 
             if (spritesFound_ > 0)
             {
@@ -1076,11 +1568,41 @@ void PPU::SpriteFetch()
 
             spriteFetchCycle_ = 0;
             ++spriteIndex_;
+
+            if (spriteIndex_ == Sprites_.size())
+            {
+                ComposeSpriteLine();
+            }
             break;
         }
     }
 }
 
+constexpr std::array<uint64_t, 256> PPU::CreatePatternRowTable(bool flipped)
+{
+    std::array<uint64_t, 256> table {};
+
+    for (size_t patternByte = 0; patternByte < 256; ++patternByte)
+    {
+        for (size_t pixel = 0; pixel < 8; ++pixel)
+        {
+            size_t bit = flipped ? pixel : (7 - pixel);
+            table[patternByte] |= static_cast<uint64_t>((patternByte >> bit) & 0x01) << (pixel * 8);
+        }
+    }
+
+    return table;
+}
+
+constexpr std::array<uint64_t, 256> PPU::PATTERN_ROWS = PPU::CreatePatternRowTable(false);
+constexpr std::array<uint64_t, 256> PPU::FLIPPED_PATTERN_ROWS = PPU::CreatePatternRowTable(true);
+
+uint64_t PPU::DecodePatternRow(uint8_t lowByte, uint8_t highByte, bool flipped)
+{
+    std::array<uint64_t, 256> const& rows = flipped ? FLIPPED_PATTERN_ROWS : PATTERN_ROWS;
+    return rows[lowByte] | (rows[highByte] << 1);
+}
+
 void PPU::CreateBackgroundPixel()
 {
     backgroundPixelAddr_ = 0x3F00;
@@ -1093,6 +1615,23 @@ void PPU::CreateBackgroundPixel()
     backgroundPixelAddr_ |= (((patternTableShifterLow_ & patternTableMask) == patternTableMask) ? 0x0001 : 0x0000);
 }
 
+uint64_t PPU::CreateBackgroundPixels()
+{
+    // The eight pixels CreateBackgroundPixel() would produce over the next eight dots, one per byte. The shift registers
+    // hold the rest of the current tile in their upper bytes and the next tile in their lower bytes, and each dot shifts
+    // once before reading, so the pixels start 1 + fine X pixels into that 16 pixel window.
+    uint64_t attributeLatch = (attributeTableLatchHigh_ ? 0x0808080808080808 : 0) |
+                              (attributeTableLatchLow_ ? 0x0404040404040404 : 0);
+
+    uint64_t currentTile = DecodePatternRow(patternTableShifterLow_ >> 8, patternTableShifterHigh_ >> 8, false) |
+                           (DecodePatternRow(attributeTableShifterLow_, attributeTableShifterHigh_, false) << 2);
+    uint64_t nextTile = DecodePatternRow(patternTableShifterLow_ & 0xFF, patternTableShifterHigh_ & 0xFF, false) |
+                        attributeLatch;
+
+    int offset = (1 + InternalRegisters_.x) * 8;
+    return (offset == 64) ? nextTile : ((currentTile >> offset) | (nextTile << (64 - offset)));
+}
+
 void PPU::CreateSpritePixel()
 {
     spritePixelAddr_ = 0x3F10;
@@ -1102,47 +1641,51 @@ void PPU::CreateSpritePixel()
         return;
     }
 
+    uint8_t spritePixel = spriteLine_[dot_];
+
+    if ((spritePixel & 0x03) != 0x00)
+    {
+        spritePixelAddr_ = 0x3F10 | (spritePixel & 0x0F);
+        checkSprite0Hit_ = ((spritePixel & SPRITE_LINE_SPRITE_0) == SPRITE_LINE_SPRITE_0);
+        backgroundPriority_ = ((spritePixel & SPRITE_LINE_PRIORITY) == SPRITE_LINE_PRIORITY);
+    }
+}
+
+void PPU::ComposeSpriteLine()
+{
+    // Lower numbered sprites are drawn last so they win where opaque pixels overlap
+    spriteLine_.fill(0x00);
+    spritesOnLine_ = false;
+    sprite0OnLine_ = false;
+
     for (int i = 7; i >= 0; --i)
     {
-        Sprite& sprite = Sprites_[i];
+        Sprite const& sprite = Sprites_[i];
 
         if (!sprite.valid)
         {
             continue;
         }
 
-        --sprite.x;
+        uint8_t attributes = ((sprite.attributes & SPRITE_PALETTE_MASK) << 2) |
+                             (sprite.attributes & SPRITE_LINE_PRIORITY) |
+                             (sprite.sprite0 ? SPRITE_LINE_SPRITE_0 : 0x00);
 
-        if ((sprite.x >= -8) && (sprite.x <= -1))
+        for (int pixel = 0; (pixel < 8) && (sprite.x + pixel < 256); ++pixel)
         {
-            uint8_t pixelNibble = ((sprite.attributes & SPRITE_PALETTE_MASK) << 2);
-
-            if ((sprite.attributes & FLIP_HORIZONTAL_MASK) == FLIP_HORIZONTAL_MASK)
-            {
-                pixelNibble |= ((sprite.patternTableHighByte & 0x01) << 1);
-                pixelNibble |= (sprite.patternTableLowByte & 0x01);
-                sprite.patternTableHighByte >>= 1;
-                sprite.patternTableLowByte >>= 1;
-            }
-            else
-            {
-                pixelNibble |= ((sprite.patternTableHighByte & 0x80) >> 6);
-                pixelNibble |= ((sprite.patternTableLowByte & 0x80) >> 7);
-                sprite.patternTableHighByte <<= 1;
-                sprite.patternTableLowByte <<= 1;
-            }
+            uint8_t color = (sprite.pixels >> (pixel * 8)) & 0x03;
 
-            if ((pixelNibble & 0x03) != 0x00)
+            if (color != 0x00)
             {
-                spritePixelAddr_ = 0x3F10 | pixelNibble;
-                checkSprite0Hit_ = sprite.sprite0;
-                backgroundPriority_ = ((sprite.attributes & BACKGROUND_PRIORITY_MASK) == BACKGROUND_PRIORITY_MASK);
+                spriteLine_[sprite.x + pixel] = attributes | color;
+                spritesOnLine_ = true;
+                sprite0OnLine_ = sprite0OnLine_ || sprite.sprite0;
             }
         }
     }
 }
 
-PPU::RGB PPU::PixelMultiplexer()
+uint16_t PPU::PixelMultiplexer()
 {
     uint16_t colorAddr = 0x3F00;
 
@@ -1194,23 +1737,46 @@ PPU::RGB PPU::PixelMultiplexer()
         }
     }
 
-    return useGrayscale_ ? GrayscaleColors_[paletteIndex_][Read(colorAddr)] : NormalColors_[paletteIndex_][Read(colorAddr)];
+    // colorAddr is always in palette RAM, so skip Read()
+    return pixelAttributes_ | (PaletteRAM_[PaletteAddress(colorAddr)] & PIXEL_COLOR_MASK);
 }
 
-void PPU::RenderPixel()
+bool PPU::PixelsNeeded() const
 {
-    RGB rgb = PixelMultiplexer();
+    // Sprite 0 hit is the only thing pixel generation can change that's visible outside the PPU
+    if (!frameSkipped_ && (reusedFrame_ == nullptr))
+    {
+        return true;
+    }
+
+    uint8_t const showBoth = SHOW_BACKGROUND_MASK | SHOW_SPRITES_MASK;
+
+    return sprite0OnLine_ && (scanline_ != 0) &&
+           ((MemMappedRegisters_.PPUMASK & showBoth) == showBoth) &&
+           ((MemMappedRegisters_.PPUSTATUS & SPRITE_0_HIT_MASK) == 0x00);
+}
+
+void PPU::SetFrameChanged()
+{
+    frameChanged_ = true;
 
-    if (overscan_ && ((scanline_ < 8) || (scanline_ > 231)))
+    if (reusedFrame_ != nullptr)
     {
-        rgb.R = 0x00;
-        rgb.G = 0x00;
-        rgb.B = 0x00;
+        // Everything output so far matches the frame being reused
+        std::copy(reusedFrame_, reusedFrame_ + framePointer_, frameBuffer_);
+        reusedFrame_ = nullptr;
     }
+}
+
+void PPU::RenderPixel()
+{
+    frameBuffer_[framePointer_++] = PixelMultiplexer();
+}
 
-    frameBuffer_[framePointer_++] = rgb.R;
-    frameBuffer_[framePointer_++] = rgb.G;
-    frameBuffer_[framePointer_++] = rgb.B;
+void PPU::SetPixelAttributes()
+{
+    pixelAttributes_ = ((MemMappedRegisters_.PPUMASK & COLOR_EMPHASIS_MASK) << (PIXEL_EMPHASIS_SHIFT - 5)) |
+                       (((MemMappedRegisters_.PPUMASK & GRAYSCALE_MASK) == GRAYSCALE_MASK) ? PIXEL_GRAYSCALE : 0x0000);
 }
 
 bool PPU::Serializable()
@@ -1265,9 +1831,10 @@ void PPU::Deserialize(std::ifstream& saveState)
     spriteFetchCycle_ = 0;
     frameReady_ = false;
     framePointer_ = 0;
+    reusedFrame_ = nullptr;
+    frameChanged_ = true;
 
-    useGrayscale_ = (MemMappedRegisters_.PPUMASK & GRAYSCALE_MASK) == GRAYSCALE_MASK;
-    paletteIndex_ = (MemMappedRegisters_.PPUMASK & COLOR_EMPHASIS_MASK) >> 5;
+    SetPixelAttributes();
 }
 
 void PPU::SetCartType()
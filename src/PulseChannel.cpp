@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <limits>
 
 PulseChannel::PulseChannel(bool onesComplement) :
     onesComplement_(onesComplement)
@@ -47,7 +48,7 @@ void PulseChannel::Reset()
     sweepTargetPeriod_ = 0;
 }
 
-uint8_t PulseChannel::GetOutput()
+uint8_t PulseChannel::GetOutput() const
 {
     if (!DUTY_CYCLE_SEQUENCE[dutyCycleIndex_][sequencerIndex_] || silenced_ || !channelEnabled_)
     {
@@ -80,6 +81,34 @@ void PulseChannel::Clock()
     }
 }
 
+void PulseChannel::Run(int clocks)
+{
+    // Same as clocks calls to Clock()
+    if (clocks <= timer_)
+    {
+        timer_ -= clocks;
+        return;
+    }
+
+    clocks -= timer_ + 1;
+    int period = timerReload_ + 1;
+    sequencerIndex_ = (sequencerIndex_ + 1 + (clocks / period)) % 8;
+    timer_ = timerReload_ - (clocks % period);
+}
+
+int PulseChannel::ClocksUntilOutputChange() const
+{
+    // The sequencer only changes the output while the channel is playing at a non-zero volume
+    uint8_t volume = useConstantVolume_ ? constantVolume_ : decayLevel_;
+
+    if (silenced_ || !channelEnabled_ || (volume == 0))
+    {
+        return std::numeric_limits<int>::max();
+    }
+
+    return timer_ + 1;
+}
+
 void PulseChannel::HalfFrameClock()
 {
     QuarterFrameClock();
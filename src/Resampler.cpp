@@ -0,0 +1,162 @@
+#include "../include/Resampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__)
+#define RESAMPLER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+constexpr double PI = 3.14159265358979323846;
+}
+
+Resampler::Resampler() :
+    position_(0),
+    step_(0),
+    tapCount_(0),
+    scale_(0.0)
+{
+    SetRates(1.0, 1.0);
+}
+
+void Resampler::SetRates(double inputRate, double outputRate)
+{
+    step_ = std::llround(inputRate / outputRate * (uint64_t{1} << POSITION_BITS));
+    double scale = std::min(1.0, outputRate / inputRate);
+
+    if ((scale_ == 0.0) || (scale > scale_ * REDESIGN_RATIO) || (scale * REDESIGN_RATIO < scale_))
+    {
+        DesignKernels(scale);
+    }
+}
+
+void Resampler::Clear()
+{
+    input_.clear();
+    position_ = 0;
+}
+
+size_t Resampler::InputNeeded(size_t count) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    uint64_t last = position_ + ((count - 1) * step_);
+    size_t needed = (last >> POSITION_BITS) + tapCount_;
+    return (needed > input_.size()) ? (needed - input_.size()) : 0;
+}
+
+void Resampler::Write(int16_t const* samples, size_t count)
+{
+    input_.insert(input_.end(), samples, samples + count);
+}
+
+size_t Resampler::Read(int16_t* samples, size_t count)
+{
+    constexpr float PHASE_SCALE = 1.0f / (uint64_t{1} << (POSITION_BITS - PHASE_BITS));
+    size_t read = 0;
+
+    for (; read < count; ++read)
+    {
+        size_t start = position_ >> POSITION_BITS;
+
+        if (start + tapCount_ > input_.size())
+        {
+            break;
+        }
+
+        uint32_t fraction = position_ & ((uint64_t{1} << POSITION_BITS) - 1);
+        size_t phase = fraction >> (POSITION_BITS - PHASE_BITS);
+        float between = (fraction & ((1 << (POSITION_BITS - PHASE_BITS)) - 1)) * PHASE_SCALE;
+
+        float const* kernel = &kernels_[phase * tapCount_];
+        float sample = Convolve(&input_[start], kernel, kernel + tapCount_, between);
+        samples[read] = std::clamp<long>(std::lround(sample), INT16_MIN, INT16_MAX);
+        position_ += step_;
+    }
+
+    // Input before the next output's first tap is no longer needed
+    size_t consumed = std::min<size_t>(position_ >> POSITION_BITS, input_.size());
+    input_.erase(input_.begin(), input_.begin() + consumed);
+    position_ -= static_cast<uint64_t>(consumed) << POSITION_BITS;
+    return read;
+}
+
+size_t Resampler::GetTapCount() const
+{
+    return tapCount_;
+}
+
+void Resampler::DesignKernels(double scale)
+{
+    // A sample at fraction f of the way past input sample start is centered at start + (tapCount_ / 2) - 1 + f, so the
+    // window covers tapCount_ / 2 samples either side of it
+    double cutoff = CUTOFF * scale;
+    size_t halfWidth = std::ceil(KERNEL_ZEROS / (2 * cutoff));
+    tapCount_ = ((2 * halfWidth) + 3) & ~size_t{3};
+    scale_ = scale;
+
+    double center = (tapCount_ / 2) - 1;
+    double windowWidth = tapCount_ / 2;
+    kernels_.assign((PHASE_COUNT + 1) * tapCount_, 0.0f);
+
+    for (size_t phase = 0; phase <= PHASE_COUNT; ++phase)
+    {
+        std::vector<double> taps(tapCount_);
+        double sum = 0.0;
+
+        for (size_t k = 0; k < tapCount_; ++k)
+        {
+            double x = k - center - (static_cast<double>(phase) / PHASE_COUNT);
+            double sinc = (x == 0.0) ? 1.0 : (std::sin(2 * PI * cutoff * x) / (2 * PI * cutoff * x));
+            double window = 0.42 + (0.5 * std::cos(PI * x / windowWidth)) + (0.08 * std::cos(2 * PI * x / windowWidth));
+            taps[k] = sinc * window;
+            sum += taps[k];
+        }
+
+        // Every phase passes DC at exactly unity gain
+        for (size_t k = 0; k < tapCount_; ++k)
+        {
+            kernels_[(phase * tapCount_) + k] = taps[k] / sum;
+        }
+    }
+}
+
+float Resampler::Convolve(float const* input, float const* kernel, float const* nextKernel, float fraction) const
+{
+#ifdef RESAMPLER_SSE2
+    __m128 sum = _mm_setzero_ps();
+    __m128 nextSum = _mm_setzero_ps();
+
+    for (size_t k = 0; k < tapCount_; k += 4)
+    {
+        __m128 samples = _mm_loadu_ps(input + k);
+        sum = _mm_add_ps(sum, _mm_mul_ps(samples, _mm_loadu_ps(kernel + k)));
+        nextSum = _mm_add_ps(nextSum, _mm_mul_ps(samples, _mm_loadu_ps(nextKernel + k)));
+    }
+
+    // Interpolate between the two phases, then add across the lanes
+    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_sub_ps(nextSum, sum), _mm_set1_ps(fraction)));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+#else
+    float sum = 0.0f;
+    float nextSum = 0.0f;
+
+    for (size_t k = 0; k < tapCount_; ++k)
+    {
+        sum += input[k] * kernel[k];
+        nextSum += input[k] * nextKernel[k];
+    }
+
+    return sum + ((nextSum - sum) * fraction);
+#endif
+}
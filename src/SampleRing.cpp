@@ -0,0 +1,85 @@
+#include "../include/SampleRing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+SampleRing::SampleRing(size_t capacity) :
+    writeIndex_(0),
+    readIndex_(0)
+{
+    size_t size = 1;
+
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    buffer_.resize(size, 0);
+    mask_ = size - 1;
+}
+
+size_t SampleRing::Write(int16_t const* samples, size_t count)
+{
+    return Push(samples, count);
+}
+
+size_t SampleRing::WriteSilence(size_t count)
+{
+    return Push(nullptr, count);
+}
+
+size_t SampleRing::Read(int16_t* samples, size_t count)
+{
+    size_t readIndex = readIndex_.load(std::memory_order_relaxed);
+    size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    count = std::min(count, writeIndex - readIndex);
+
+    // Copied in up to two pieces, the second one starting back at the beginning of the buffer
+    size_t start = readIndex & mask_;
+    size_t firstPart = std::min(count, buffer_.size() - start);
+    std::copy_n(buffer_.begin() + start, firstPart, samples);
+    std::copy_n(buffer_.begin(), count - firstPart, samples + firstPart);
+
+    readIndex_.store(readIndex + count, std::memory_order_release);
+    return count;
+}
+
+size_t SampleRing::Size() const
+{
+    // Read before write, so the write index can only have moved further ahead
+    size_t readIndex = readIndex_.load(std::memory_order_acquire);
+    size_t writeIndex = writeIndex_.load(std::memory_order_acquire);
+    return writeIndex - readIndex;
+}
+
+size_t SampleRing::Capacity() const
+{
+    return buffer_.size();
+}
+
+size_t SampleRing::Push(int16_t const* samples, size_t count)
+{
+    // Writes silence when there are no samples
+    size_t writeIndex = writeIndex_.load(std::memory_order_relaxed);
+    size_t readIndex = readIndex_.load(std::memory_order_acquire);
+    count = std::min(count, buffer_.size() - (writeIndex - readIndex));
+
+    size_t start = writeIndex & mask_;
+    size_t firstPart = std::min(count, buffer_.size() - start);
+
+    if (samples != nullptr)
+    {
+        std::copy_n(samples, firstPart, buffer_.begin() + start);
+        std::copy_n(samples + firstPart, count - firstPart, buffer_.begin());
+    }
+    else
+    {
+        std::fill_n(buffer_.begin() + start, firstPart, 0);
+        std::fill_n(buffer_.begin(), count - firstPart, 0);
+    }
+
+    writeIndex_.store(writeIndex + count, std::memory_order_release);
+    return count;
+}
@@ -0,0 +1,1212 @@
+#include "../include/Scaler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__SSE2__)
+#define SCALER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+uint32_t const* SourceRow(uint32_t const* frame, size_t row, int offset)
+{
+    // Rows past the top and bottom edges repeat the edge rows
+    int clamped = std::clamp<int>(static_cast<int>(row) + offset, 0, FRAME_HEIGHT - 1);
+    return frame + (clamped * FRAME_WIDTH);
+}
+
+uint32_t* OutputRow(uint8_t* pixels, size_t pitch, size_t row)
+{
+    return reinterpret_cast<uint32_t*>(pixels + (row * pitch));
+}
+
+size_t Left(size_t x)
+{
+    return (x == 0) ? 0 : (x - 1);
+}
+
+size_t Right(size_t x)
+{
+    return (x == FRAME_WIDTH - 1) ? x : (x + 1);
+}
+
+void Scale2xPixel(uint32_t const* above, uint32_t const* row, uint32_t const* below, size_t x,
+                  uint32_t* out0, uint32_t* out1)
+{
+    uint32_t b = above[x];
+    uint32_t d = row[Left(x)];
+    uint32_t e = row[x];
+    uint32_t f = row[Right(x)];
+    uint32_t h = below[x];
+
+    out0[(x * 2)] = ((d == b) && (b != f) && (d != h)) ? d : e;
+    out0[(x * 2) + 1] = ((b == f) && (b != d) && (f != h)) ? f : e;
+    out1[(x * 2)] = ((d == h) && (d != b) && (h != f)) ? d : e;
+    out1[(x * 2) + 1] = ((h == f) && (d != h) && (b != f)) ? f : e;
+}
+
+void Scale3xPixel(uint32_t const* above, uint32_t const* row, uint32_t const* below, size_t x,
+                  uint32_t* out0, uint32_t* out1, uint32_t* out2)
+{
+    uint32_t a = above[Left(x)];
+    uint32_t b = above[x];
+    uint32_t c = above[Right(x)];
+    uint32_t d = row[Left(x)];
+    uint32_t e = row[x];
+    uint32_t f = row[Right(x)];
+    uint32_t g = below[Left(x)];
+    uint32_t h = below[x];
+    uint32_t i = below[Right(x)];
+
+    bool topLeft = (d == b) && (b != f) && (d != h);
+    bool topRight = (b == f) && (b != d) && (f != h);
+    bool bottomLeft = (d == h) && (d != b) && (h != f);
+    bool bottomRight = (h == f) && (d != h) && (b != f);
+
+    out0[(x * 3)] = topLeft ? d : e;
+    out0[(x * 3) + 1] = ((topLeft && (e != c)) || (topRight && (e != a))) ? b : e;
+    out0[(x * 3) + 2] = topRight ? f : e;
+    out1[(x * 3)] = ((topLeft && (e != g)) || (bottomLeft && (e != a))) ? d : e;
+    out1[(x * 3) + 1] = e;
+    out1[(x * 3) + 2] = ((topRight && (e != i)) || (bottomRight && (e != c))) ? f : e;
+    out2[(x * 3)] = bottomLeft ? d : e;
+    out2[(x * 3) + 1] = ((bottomLeft && (e != i)) || (bottomRight && (e != g))) ? h : e;
+    out2[(x * 3) + 2] = bottomRight ? f : e;
+}
+
+// HQx neighbours are numbered (dy + 1) * 3 + dx + 1 around E, and the pattern has a bit for each of them but E
+constexpr size_t HQ_CENTER = 4;
+
+constexpr size_t HqPosition(int dx, int dy)
+{
+    return ((dy + 1) * 3) + dx + 1;
+}
+
+constexpr uint32_t HqPatternBit(size_t position)
+{
+    return 1u << ((position < HQ_CENTER) ? position : (position - 1));
+}
+
+// The corners of E, numbered 0-3 from top left to bottom right, that an output pixel's rule depends on. Corner output
+// pixels depend on one, the edges between them on two and the middle of a 3x3 block on none.
+constexpr std::array<size_t, 2> HqOutputCorners(size_t scale, size_t output)
+{
+    size_t x = ((output % scale) * 2) / (scale - 1);
+    size_t y = ((output / scale) * 2) / (scale - 1);
+
+    if ((x != 1) && (y != 1))
+    {
+        return {(x / 2) + (y / 2) * 2, (x / 2) + (y / 2) * 2};
+    }
+    else if (y != 1)
+    {
+        return {(y / 2) * 2, ((y / 2) * 2) + 1};
+    }
+    else if (x != 1)
+    {
+        return {x / 2, (x / 2) + 2};
+    }
+
+    return {0, 0};
+}
+
+bool YuvDiffers(uint32_t a, uint32_t b)
+{
+    // HQx's thresholds of 48 for Y, 7 for U and 6 for V
+    auto difference = [=](int shift) { return std::abs(int((a >> shift) & 0xFF) - int((b >> shift) & 0xFF)); };
+    return (difference(16) > 48) || (difference(8) > 7) || (difference(0) > 6);
+}
+
+#ifdef SCALER_SSE2
+__m128i Load(uint32_t const* src)
+{
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(src));
+}
+
+void Store(uint32_t* dst, __m128i pixels)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), pixels);
+}
+
+__m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// mask & ~(a | b)
+__m128i AndNeither(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_andnot_si128(_mm_or_si128(a, b), mask);
+}
+
+void StoreInterleaved3(uint32_t* dst, __m128i a, __m128i b, __m128i c)
+{
+    // a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3
+    __m128 abLow = _mm_castsi128_ps(_mm_unpacklo_epi32(a, b));
+    __m128 abHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(a, b));
+    __m128 bcLow = _mm_castsi128_ps(_mm_unpacklo_epi32(b, c));
+    __m128 bcHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(b, c));
+    __m128 caLow = _mm_castsi128_ps(_mm_unpacklo_epi32(c, a));
+    __m128 caHigh = _mm_castsi128_ps(_mm_unpackhi_epi32(c, a));
+
+    Store(dst, _mm_castps_si128(_mm_shuffle_ps(abLow, caLow, _MM_SHUFFLE(3, 0, 1, 0))));
+    Store(dst + 4, _mm_castps_si128(_mm_shuffle_ps(bcLow, abHigh, _MM_SHUFFLE(1, 0, 3, 2))));
+    Store(dst + 8, _mm_castps_si128(_mm_shuffle_ps(caHigh, bcHigh, _MM_SHUFFLE(3, 2, 3, 0))));
+}
+
+void Scale2xBlock(uint32_t const* above, uint32_t const* row, uint32_t const* below, size_t x,
+                  uint32_t* out0, uint32_t* out1)
+{
+    // Four pixels at once, x must be at least 1 from either edge
+    __m128i b = Load(above + x);
+    __m128i d = Load(row + x - 1);
+    __m128i e = Load(row + x);
+    __m128i f = Load(row + x + 1);
+    __m128i h = Load(below + x);
+
+    __m128i db = _mm_cmpeq_epi32(d, b);
+    __m128i bf = _mm_cmpeq_epi32(b, f);
+    __m128i dh = _mm_cmpeq_epi32(d, h);
+    __m128i hf = _mm_cmpeq_epi32(h, f);
+
+    __m128i e0 = Select(AndNeither(db, bf, dh), d, e);
+    __m128i e1 = Select(AndNeither(bf, db, hf), f, e);
+    __m128i e2 = Select(AndNeither(dh, db, hf), d, e);
+    __m128i e3 = Select(AndNeither(hf, dh, bf), f, e);
+
+    Store(out0 + (x * 2), _mm_unpacklo_epi32(e0, e1));
+    Store(out0 + (x * 2) + 4, _mm_unpackhi_epi32(e0, e1));
+    Store(out1 + (x * 2), _mm_unpacklo_epi32(e2, e3));
+    Store(out1 + (x * 2) + 4, _mm_unpackhi_epi32(e2, e3));
+}
+
+void Scale3xBlock(uint32_t const* above, uint32_t const* row, uint32_t const* below, size_t x,
+                  uint32_t* out0, uint32_t* out1, uint32_t* out2)
+{
+    // Four pixels at once, x must be at least 1 from either edge
+    __m128i a = Load(above + x - 1);
+    __m128i b = Load(above + x);
+    __m128i c = Load(above + x + 1);
+    __m128i d = Load(row + x - 1);
+    __m128i e = Load(row + x);
+    __m128i f = Load(row + x + 1);
+    __m128i g = Load(below + x - 1);
+    __m128i h = Load(below + x);
+    __m128i i = Load(below + x + 1);
+
+    __m128i db = _mm_cmpeq_epi32(d, b);
+    __m128i bf = _mm_cmpeq_epi32(b, f);
+    __m128i dh = _mm_cmpeq_epi32(d, h);
+    __m128i hf = _mm_cmpeq_epi32(h, f);
+    __m128i ea = _mm_cmpeq_epi32(e, a);
+    __m128i ec = _mm_cmpeq_epi32(e, c);
+    __m128i eg = _mm_cmpeq_epi32(e, g);
+    __m128i ei = _mm_cmpeq_epi32(e, i);
+
+    __m128i topLeft = AndNeither(db, bf, dh);
+    __m128i topRight = AndNeither(bf, db, hf);
+    __m128i bottomLeft = AndNeither(dh, db, hf);
+    __m128i bottomRight = AndNeither(hf, dh, bf);
+
+    __m128i e1 = Select(_mm_or_si128(_mm_andnot_si128(ec, topLeft), _mm_andnot_si128(ea, topRight)), b, e);
+    __m128i e3 = Select(_mm_or_si128(_mm_andnot_si128(eg, topLeft), _mm_andnot_si128(ea, bottomLeft)), d, e);
+    __m128i e5 = Select(_mm_or_si128(_mm_andnot_si128(ei, topRight), _mm_andnot_si128(ec, bottomRight)), f, e);
+    __m128i e7 = Select(_mm_or_si128(_mm_andnot_si128(ei, bottomLeft), _mm_andnot_si128(eg, bottomRight)), h, e);
+
+    StoreInterleaved3(out0 + (x * 3), Select(topLeft, d, e), e1, Select(topRight, f, e));
+    StoreInterleaved3(out1 + (x * 3), e3, e, e5);
+    StoreInterleaved3(out2 + (x * 3), Select(bottomLeft, d, e), e7, Select(bottomRight, f, e));
+}
+
+// YuvDiffers() for four pairs of pixels, as a mask with a bit for each
+int YuvDiffers4(__m128i a, __m128i b)
+{
+    // Bytes of the difference over the thresholds are left non-zero
+    __m128i difference = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+    __m128i over = _mm_subs_epu8(difference, _mm_set1_epi32(0x00300706));
+    return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(over, _mm_setzero_si128()))) ^ 0x0F;
+}
+
+// YuvDistance() for four pairs of pixels
+__m128i YuvDistance4(__m128i a, __m128i b)
+{
+    // Each pixel's V and U weigh into one 32 bit sum and its Y into the next, which are then added together
+    __m128i difference = _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+    __m128i weights = _mm_set_epi16(0, 48, 7, 6, 0, 48, 7, 6);
+    __m128 low = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpacklo_epi8(difference, _mm_setzero_si128()), weights));
+    __m128 high = _mm_castsi128_ps(_mm_madd_epi16(_mm_unpackhi_epi8(difference, _mm_setzero_si128()), weights));
+    return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))),
+                         _mm_castps_si128(_mm_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))));
+}
+
+int MoveMask(__m128i mask)
+{
+    return _mm_movemask_ps(_mm_castsi128_ps(mask));
+}
+#endif
+}
+
+char const* ScalerName(ScalerType type)
+{
+    switch (type)
+    {
+        case ScalerType::SCALE2X:
+            return "Scale2x";
+        case ScalerType::SCALE3X:
+            return "Scale3x";
+        case ScalerType::HQ2X:
+            return "HQ2x";
+        case ScalerType::HQ3X:
+            return "HQ3x";
+        case ScalerType::XBR2X:
+            return "2xBR";
+        default:
+            return "None";
+    }
+}
+
+ThreadPool::ThreadPool(size_t threads) :
+    job_(nullptr),
+    jobCount_(0),
+    nextJob_(0),
+    busyWorkers_(0),
+    generation_(0),
+    stopping_(false)
+{
+    for (size_t i = 1; i < threads; ++i)
+    {
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    startCondition_.notify_all();
+
+    for (std::thread& worker : workers_)
+    {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::ThreadCount() const
+{
+    return workers_.size() + 1;
+}
+
+void ThreadPool::ParallelFor(size_t count, std::function<void(size_t)> const& job)
+{
+    if (workers_.empty())
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &job;
+        jobCount_ = count;
+        nextJob_ = 0;
+        busyWorkers_ = workers_.size();
+        ++generation_;
+    }
+
+    startCondition_.notify_all();
+    RunJobs();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCondition_.wait(lock, [this]() { return busyWorkers_ == 0; });
+    job_ = nullptr;
+}
+
+void ThreadPool::WorkerLoop()
+{
+    // Every worker takes part in each ParallelFor call, even if the jobs have all been taken by the time it wakes
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            startCondition_.wait(lock, [&]() { return stopping_ || (generation_ != generation); });
+
+            if (stopping_)
+            {
+                return;
+            }
+
+            generation = generation_;
+        }
+
+        RunJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --busyWorkers_;
+        }
+
+        doneCondition_.notify_one();
+    }
+}
+
+void ThreadPool::RunJobs()
+{
+    for (size_t i = nextJob_.fetch_add(1); i < jobCount_; i = nextJob_.fetch_add(1))
+    {
+        (*job_)(i);
+    }
+}
+
+Scaler::Scaler(size_t threads) :
+    pool_(std::max<size_t>(threads, 1)),
+    yuv_(std::make_unique<uint32_t[]>(FRAME_BUFFER_SIZE))
+{
+}
+
+size_t Scaler::DefaultThreadCount()
+{
+    // hardware_concurrency() is 0 when unknown
+    size_t cores = std::thread::hardware_concurrency();
+    return (cores > 2) ? std::min<size_t>(cores - 2, 4) : 1;
+}
+
+size_t Scaler::ThreadCount() const
+{
+    return pool_.ThreadCount();
+}
+
+void Scaler::Scale(ScalerType type, uint32_t const* frame, uint8_t* pixels, size_t pitch)
+{
+    auto forEachBand = [&](auto rows)
+    {
+        pool_.ParallelFor(BAND_COUNT, [&](size_t band)
+        {
+            size_t firstRow = band * BAND_HEIGHT;
+            rows(firstRow, std::min(firstRow + BAND_HEIGHT, FRAME_HEIGHT));
+        });
+    };
+
+    switch (type)
+    {
+        case ScalerType::SCALE2X:
+            forEachBand([&](size_t firstRow, size_t endRow) { Scale2xRows(frame, pixels, pitch, firstRow, endRow); });
+            break;
+        case ScalerType::SCALE3X:
+            forEachBand([&](size_t firstRow, size_t endRow) { Scale3xRows(frame, pixels, pitch, firstRow, endRow); });
+            break;
+        case ScalerType::HQ2X:
+        case ScalerType::HQ3X:
+        case ScalerType::XBR2X:
+            // Every band reads the YUV values of the rows around it, so they all have to be converted first
+            forEachBand([&](size_t firstRow, size_t endRow) { ConvertYuvRows(frame, firstRow, endRow); });
+
+            if (type == ScalerType::HQ2X)
+            {
+                forEachBand([&](size_t firstRow, size_t endRow)
+                {
+                    HqRows<2>(HQ2X_RULES, frame, pixels, pitch, firstRow, endRow);
+                });
+            }
+            else if (type == ScalerType::HQ3X)
+            {
+                forEachBand([&](size_t firstRow, size_t endRow)
+                {
+                    HqRows<3>(HQ3X_RULES, frame, pixels, pitch, firstRow, endRow);
+                });
+            }
+            else
+            {
+                forEachBand([&](size_t firstRow, size_t endRow) { Xbr2xRows(frame, pixels, pitch, firstRow, endRow); });
+            }
+            break;
+        default:
+            for (size_t row = 0; row < FRAME_HEIGHT; ++row)
+            {
+                std::memcpy(pixels + (row * pitch), frame + (row * FRAME_WIDTH), FRAME_WIDTH * sizeof(uint32_t));
+            }
+            break;
+    }
+}
+
+void Scaler::Scale2xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const
+{
+    for (size_t row = firstRow; row < endRow; ++row)
+    {
+        uint32_t const* above = SourceRow(frame, row, -1);
+        uint32_t const* current = SourceRow(frame, row, 0);
+        uint32_t const* below = SourceRow(frame, row, 1);
+        uint32_t* out0 = OutputRow(pixels, pitch, row * 2);
+        uint32_t* out1 = OutputRow(pixels, pitch, (row * 2) + 1);
+        size_t x = 0;
+
+#ifdef SCALER_SSE2
+        for (; x < 4; ++x)
+        {
+            Scale2xPixel(above, current, below, x, out0, out1);
+        }
+
+        for (; x + 4 < FRAME_WIDTH; x += 4)
+        {
+            Scale2xBlock(above, current, below, x, out0, out1);
+        }
+#endif
+
+        for (; x < FRAME_WIDTH; ++x)
+        {
+            Scale2xPixel(above, current, below, x, out0, out1);
+        }
+    }
+}
+
+void Scaler::Scale3xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const
+{
+    for (size_t row = firstRow; row < endRow; ++row)
+    {
+        uint32_t const* above = SourceRow(frame, row, -1);
+        uint32_t const* current = SourceRow(frame, row, 0);
+        uint32_t const* below = SourceRow(frame, row, 1);
+        uint32_t* out0 = OutputRow(pixels, pitch, row * 3);
+        uint32_t* out1 = OutputRow(pixels, pitch, (row * 3) + 1);
+        uint32_t* out2 = OutputRow(pixels, pitch, (row * 3) + 2);
+        size_t x = 0;
+
+#ifdef SCALER_SSE2
+        for (; x < 4; ++x)
+        {
+            Scale3xPixel(above, current, below, x, out0, out1, out2);
+        }
+
+        for (; x + 4 < FRAME_WIDTH; x += 4)
+        {
+            Scale3xBlock(above, current, below, x, out0, out1, out2);
+        }
+#endif
+
+        for (; x < FRAME_WIDTH; ++x)
+        {
+            Scale3xPixel(above, current, below, x, out0, out1, out2);
+        }
+    }
+}
+
+void Scaler::ConvertYuvRows(uint32_t const* frame, size_t firstRow, size_t endRow)
+{
+    // Y in bits 16-23, U and V offset by 128 in bits 8-15 and 0-7
+    for (size_t i = firstRow * FRAME_WIDTH; i < endRow * FRAME_WIDTH; ++i)
+    {
+        std::array<uint8_t, 4> bgra;
+        std::memcpy(bgra.data(), &frame[i], sizeof(uint32_t));
+        int b = bgra[0];
+        int g = bgra[1];
+        int r = bgra[2];
+
+        int y = ((299 * r) + (587 * g) + (114 * b)) / 1000;
+        int u = 128 + (((-169 * r) - (331 * g) + (500 * b)) / 1000);
+        int v = 128 + (((500 * r) - (419 * g) - (81 * b)) / 1000);
+        yuv_[i] = (y << 16) | (u << 8) | v;
+    }
+}
+
+template <size_t Factor>
+constexpr Scaler::HqRules<Factor> Scaler::CreateHqRules()
+{
+    // Each rule mixes E with the neighbours nearest the output pixel that look like part of the same surface, or pulls
+    // it toward the far side of an edge running past it. Edges across a corner are told apart by the neighbours further
+    // along them: both differing means a 45 degree edge, one differing a shallower or steeper one.
+    HqRules<Factor> rules {};
+
+    auto mix = [](uint8_t weight, size_t first = HQ_CENTER, uint8_t firstWeight = 0, size_t second = HQ_CENTER,
+                  uint8_t secondWeight = 0)
+    {
+        return HqRule {weight, static_cast<uint8_t>(first), firstWeight, static_cast<uint8_t>(second), secondWeight};
+    };
+
+    for (uint32_t pattern = 0; pattern < 256; ++pattern)
+    {
+        auto differs = [&](int dx, int dy) { return (pattern & HqPatternBit(HqPosition(dx, dy))) != 0; };
+
+        // The neighbours beside the corner at dx, dy and the one diagonal to it all differ from E but not each other
+        auto cornerEdge = [&](int dx, int dy, bool sidesDiffer)
+        {
+            return !sidesDiffer && differs(dx, 0) && differs(0, dy) && differs(dx, dy);
+        };
+
+        auto diagonalEdge = [&](int dx, int dy, bool sidesDiffer)
+        {
+            return cornerEdge(dx, dy, sidesDiffer) && differs(-dx, dy) && differs(dx, -dy);
+        };
+
+        auto corner = [&](int dx, int dy, bool sidesDiffer)
+        {
+            size_t diagonal = HqPosition(dx, dy);
+            size_t vertical = HqPosition(0, dy);
+            size_t horizontal = HqPosition(dx, 0);
+
+            if (!differs(0, dy) && !differs(dx, 0))
+            {
+                return mix(8, vertical, 4, horizontal, 4);
+            }
+            else if (!differs(0, dy) || !differs(dx, 0))
+            {
+                size_t similar = differs(0, dy) ? horizontal : vertical;
+                return differs(dx, dy) ? mix(12, similar, 4) : mix(8, diagonal, 4, similar, 4);
+            }
+            else if (sidesDiffer)
+            {
+                return differs(dx, dy) ? mix(16) : mix(12, diagonal, 4);
+            }
+            else if (!cornerEdge(dx, dy, sidesDiffer))
+            {
+                return mix(8, vertical, 4, horizontal, 4);
+            }
+
+            bool alongVertical = differs(-dx, dy);
+            bool alongHorizontal = differs(dx, -dy);
+
+            if (Factor == 3)
+            {
+                // The corner output pixels of a 3x3 block sit far enough out to take the neighbours' color outright
+                if (alongVertical && alongHorizontal)
+                {
+                    return mix(0, vertical, 8, horizontal, 8);
+                }
+
+                return (alongVertical || alongHorizontal) ? mix(2, vertical, 7, horizontal, 7)
+                                                          : mix(8, vertical, 4, horizontal, 4);
+            }
+            else if (alongVertical && alongHorizontal)
+            {
+                return mix(4, vertical, 6, horizontal, 6);
+            }
+            else if (alongVertical)
+            {
+                return mix(10, vertical, 4, horizontal, 2);
+            }
+            else if (alongHorizontal)
+            {
+                return mix(10, horizontal, 4, vertical, 2);
+            }
+
+            return mix(12, vertical, 2, horizontal, 2);
+        };
+
+        // The output pixel between two corners, firstDiffer being for the one toward the top or left
+        auto side = [&](int dx, int dy, bool firstDiffer, bool secondDiffer)
+        {
+            int firstX = (dx == 0) ? -1 : dx;
+            int firstY = (dy == 0) ? -1 : dy;
+            int secondX = (dx == 0) ? 1 : dx;
+            int secondY = (dy == 0) ? 1 : dy;
+            size_t beside = HqPosition(dx, dy);
+
+            if (!differs(dx, dy))
+            {
+                return mix(12, beside, 4);
+            }
+            else if (diagonalEdge(firstX, firstY, firstDiffer) || diagonalEdge(secondX, secondY, secondDiffer))
+            {
+                return mix(4, beside, 12);
+            }
+            else if (cornerEdge(firstX, firstY, firstDiffer) || cornerEdge(secondX, secondY, secondDiffer))
+            {
+                return mix(14, beside, 2);
+            }
+
+            return mix(16);
+        };
+
+        for (size_t output = 0; output < Factor * Factor; ++output)
+        {
+            int dx = static_cast<int>(((output % Factor) * 2) / (Factor - 1)) - 1;
+            int dy = static_cast<int>(((output / Factor) * 2) / (Factor - 1)) - 1;
+
+            for (size_t index = 0; index < 4; ++index)
+            {
+                bool firstDiffer = (index & 0x01) != 0;
+                bool secondDiffer = (index & 0x02) != 0;
+
+                if ((dx != 0) && (dy != 0))
+                {
+                    rules[pattern][output][index] = corner(dx, dy, firstDiffer);
+                }
+                else if ((dx != 0) || (dy != 0))
+                {
+                    rules[pattern][output][index] = side(dx, dy, firstDiffer, secondDiffer);
+                }
+                else
+                {
+                    rules[pattern][output][index] = mix(16);
+                }
+            }
+        }
+    }
+
+    return rules;
+}
+
+constexpr Scaler::HqRules<2> Scaler::HQ2X_RULES = Scaler::CreateHqRules<2>();
+constexpr Scaler::HqRules<3> Scaler::HQ3X_RULES = Scaler::CreateHqRules<3>();
+
+template <size_t Factor>
+void Scaler::HqRows(HqRules<Factor> const& rules, uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow,
+                    size_t endRow) const
+{
+    std::array<uint32_t, 9> neighbours;
+    std::array<uint32_t, 9> neighbourYuv;
+
+    for (size_t row = firstRow; row < endRow; ++row)
+    {
+        std::array<uint32_t const*, 3> rows;
+        std::array<uint32_t const*, 3> yuvRows;
+        std::array<uint32_t*, Factor> out;
+
+        for (int dy = -1; dy <= 1; ++dy)
+        {
+            rows[dy + 1] = SourceRow(frame, row, dy);
+            yuvRows[dy + 1] = yuv_.get() + (rows[dy + 1] - frame);
+        }
+
+        for (size_t i = 0; i < Factor; ++i)
+        {
+            out[i] = OutputRow(pixels, pitch, (row * Factor) + i);
+        }
+
+        auto scalePixel = [&](size_t x)
+        {
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    size_t column = (dx < 0) ? Left(x) : ((dx > 0) ? Right(x) : x);
+                    neighbours[HqPosition(dx, dy)] = rows[dy + 1][column];
+                    neighbourYuv[HqPosition(dx, dy)] = yuvRows[dy + 1][column];
+                }
+            }
+
+            uint8_t pattern = 0;
+
+            for (size_t position = 0; position < 9; ++position)
+            {
+                if ((position != HQ_CENTER) && YuvDiffers(neighbourYuv[HQ_CENTER], neighbourYuv[position]))
+                {
+                    pattern |= HqPatternBit(position);
+                }
+            }
+
+            uint8_t cornerDiffs = (YuvDiffers(neighbourYuv[1], neighbourYuv[3]) ? 0x01 : 0) |
+                                  (YuvDiffers(neighbourYuv[1], neighbourYuv[5]) ? 0x02 : 0) |
+                                  (YuvDiffers(neighbourYuv[7], neighbourYuv[3]) ? 0x04 : 0) |
+                                  (YuvDiffers(neighbourYuv[7], neighbourYuv[5]) ? 0x08 : 0);
+            HqPixel(rules, neighbours, pattern, cornerDiffs, out, x);
+        };
+
+        size_t x = 0;
+
+#ifdef SCALER_SSE2
+        for (; x < 4; ++x)
+        {
+            scalePixel(x);
+        }
+
+        for (; x + 4 < FRAME_WIDTH; x += 4)
+        {
+            // Four pixels at once, x must be at least 1 from either edge. Their patterns are found together, then the
+            // output pixels of any that aren't in the middle of a flat area are mixed one source pixel at a time.
+            __m128i e = Load(rows[1] + x);
+            __m128i yuv[9];  // Arrays of vectors can't be std::arrays without losing their alignment attribute
+            std::array<int, 9> differs;
+            int flat = 0x0F;
+
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    size_t position = HqPosition(dx, dy);
+                    yuv[position] = Load(yuvRows[dy + 1] + x + dx);
+                    flat &= MoveMask(_mm_cmpeq_epi32(Load(rows[dy + 1] + x + dx), e));
+                }
+            }
+
+            if (flat == 0x0F)
+            {
+                for (size_t i = 0; i < Factor; ++i)
+                {
+                    if constexpr (Factor == 2)
+                    {
+                        Store(out[i] + (x * 2), _mm_unpacklo_epi32(e, e));
+                        Store(out[i] + (x * 2) + 4, _mm_unpackhi_epi32(e, e));
+                    }
+                    else
+                    {
+                        StoreInterleaved3(out[i] + (x * 3), e, e, e);
+                    }
+                }
+
+                continue;
+            }
+
+            for (size_t position = 0; position < 9; ++position)
+            {
+                differs[position] = YuvDiffers4(yuv[HQ_CENTER], yuv[position]);
+            }
+
+            std::array<int, 4> cornerDiffs = {YuvDiffers4(yuv[1], yuv[3]), YuvDiffers4(yuv[1], yuv[5]),
+                                              YuvDiffers4(yuv[7], yuv[3]), YuvDiffers4(yuv[7], yuv[5])};
+
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                uint8_t pattern = 0;
+                uint8_t corners = 0;
+
+                for (int dy = -1; dy <= 1; ++dy)
+                {
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        size_t position = HqPosition(dx, dy);
+                        neighbours[position] = rows[dy + 1][x + lane + dx];
+                        pattern |= ((differs[position] >> lane) & 0x01) != 0 ? HqPatternBit(position) : 0;
+                    }
+                }
+
+                for (size_t corner = 0; corner < 4; ++corner)
+                {
+                    corners |= ((cornerDiffs[corner] >> lane) & 0x01) << corner;
+                }
+
+                HqPixel(rules, neighbours, pattern, corners, out, x + lane);
+            }
+        }
+#endif
+
+        for (; x < FRAME_WIDTH; ++x)
+        {
+            scalePixel(x);
+        }
+    }
+}
+
+template <size_t Factor>
+void Scaler::HqPixel(HqRules<Factor> const& rules, std::array<uint32_t, 9> const& neighbours, uint8_t pattern,
+                     uint8_t cornerDiffs, std::array<uint32_t*, Factor> const& out, size_t x)
+{
+    auto rule = [&](size_t output) -> HqRule const&
+    {
+        std::array<size_t, 2> corners = HqOutputCorners(Factor, output);
+        size_t index = ((cornerDiffs >> corners[0]) & 0x01) | (((cornerDiffs >> corners[1]) & 0x01) << 1);
+        return rules[pattern][output][index];
+    };
+
+#ifdef SCALER_SSE2
+    // Two output pixels at a time, with each channel widened to 16 bits
+    __m128i e = _mm_unpacklo_epi8(_mm_set1_epi32(neighbours[HQ_CENTER]), _mm_setzero_si128());
+
+    auto mixPair = [&](HqRule const& left, HqRule const& right)
+    {
+        auto pair = [&](uint8_t a, uint8_t b)
+        {
+            __m128i packed = _mm_unpacklo_epi32(_mm_cvtsi32_si128(neighbours[a]), _mm_cvtsi32_si128(neighbours[b]));
+            return _mm_unpacklo_epi8(packed, _mm_setzero_si128());
+        };
+
+        auto weights = [](uint8_t a, uint8_t b) { return _mm_unpacklo_epi64(_mm_set1_epi16(a), _mm_set1_epi16(b)); };
+
+        __m128i sum = _mm_mullo_epi16(e, weights(left.weight, right.weight));
+        sum = _mm_add_epi16(sum, _mm_mullo_epi16(pair(left.first, right.first),
+                                                 weights(left.firstWeight, right.firstWeight)));
+        sum = _mm_add_epi16(sum, _mm_mullo_epi16(pair(left.second, right.second),
+                                                 weights(left.secondWeight, right.secondWeight)));
+        sum = _mm_srli_epi16(sum, 4);
+        return _mm_packus_epi16(sum, sum);
+    };
+
+    for (size_t y = 0; y < Factor; ++y)
+    {
+        uint32_t* dst = out[y] + (x * Factor);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst), mixPair(rule(y * Factor), rule((y * Factor) + 1)));
+
+        if constexpr (Factor == 3)
+        {
+            dst[2] = _mm_cvtsi128_si32(mixPair(rule((y * 3) + 2), rule((y * 3) + 2)));
+        }
+    }
+#else
+    // Weights are in 16ths, so each channel's sum fits in 12 bits and two channels can be mixed at once
+    auto mix = [&](HqRule const& rule, int shift)
+    {
+        auto channels = [&](size_t position) { return (neighbours[position] >> shift) & 0x00FF00FF; };
+        uint32_t sum = (channels(HQ_CENTER) * rule.weight) + (channels(rule.first) * rule.firstWeight) +
+                       (channels(rule.second) * rule.secondWeight);
+        return ((sum >> 4) & 0x00FF00FF) << shift;
+    };
+
+    for (size_t y = 0; y < Factor; ++y)
+    {
+        for (size_t column = 0; column < Factor; ++column)
+        {
+            HqRule const& outputRule = rule((y * Factor) + column);
+            out[y][(x * Factor) + column] = mix(outputRule, 0) | mix(outputRule, 8);
+        }
+    }
+#endif
+}
+
+void Scaler::Xbr2xRows(uint32_t const* frame, uint8_t* pixels, size_t pitch, size_t firstRow, size_t endRow) const
+{
+    std::array<uint32_t, GRID_SIZE> gridPixels;
+    std::array<uint32_t, GRID_SIZE> gridYuv;
+    std::array<uint32_t, 4> block;
+
+    for (size_t row = firstRow; row < endRow; ++row)
+    {
+        std::array<size_t, 5> rowOffsets;
+
+        for (int dy = -2; dy <= 2; ++dy)
+        {
+            rowOffsets[dy + 2] = SourceRow(frame, row, dy) - frame;
+        }
+
+        uint32_t const* above = frame + rowOffsets[1];
+        uint32_t const* current = frame + rowOffsets[2];
+        uint32_t const* below = frame + rowOffsets[3];
+        uint32_t* out0 = OutputRow(pixels, pitch, row * 2);
+        uint32_t* out1 = OutputRow(pixels, pitch, (row * 2) + 1);
+
+        auto scalePixel = [&](size_t x)
+        {
+            // Each corner is left alone when E matches one of the two pixels beside it, which covers most of a frame
+            uint32_t e = current[x];
+            bool sameB = (above[x] == e);
+            bool sameD = (current[Left(x)] == e);
+            bool sameF = (current[Right(x)] == e);
+            bool sameH = (below[x] == e);
+
+            if ((sameH || sameF) && (sameD || sameH) && (sameB || sameD) && (sameF || sameB))
+            {
+                out0[(x * 2)] = out0[(x * 2) + 1] = e;
+                out1[(x * 2)] = out1[(x * 2) + 1] = e;
+                return;
+            }
+
+            for (int dx = -2; dx <= 2; ++dx)
+            {
+                size_t column = std::clamp<int>(static_cast<int>(x) + dx, 0, FRAME_WIDTH - 1);
+
+                for (size_t gridRow = 0; gridRow < 5; ++gridRow)
+                {
+                    size_t i = rowOffsets[gridRow] + column;
+                    gridPixels[(gridRow * 5) + dx + 2] = frame[i];
+                    gridYuv[(gridRow * 5) + dx + 2] = yuv_[i];
+                }
+            }
+
+            block.fill(gridPixels[12]);
+
+            for (GridRotation const& rotation : GRID_ROTATIONS)
+            {
+                BlendXbr2xCorner(Xbr2xCorner(gridPixels, gridYuv, rotation), gridPixels, rotation, block);
+            }
+
+            out0[(x * 2)] = block[0];
+            out0[(x * 2) + 1] = block[1];
+            out1[(x * 2)] = block[2];
+            out1[(x * 2) + 1] = block[3];
+        };
+
+        size_t x = 0;
+
+#ifdef SCALER_SSE2
+        for (; x < 4; ++x)
+        {
+            scalePixel(x);
+        }
+
+        for (; x + 6 <= FRAME_WIDTH; x += 4)
+        {
+            Xbr2xBlock(frame, rowOffsets, x, out0, out1);
+        }
+#endif
+
+        for (; x < FRAME_WIDTH; ++x)
+        {
+            scalePixel(x);
+        }
+    }
+}
+
+#ifdef SCALER_SSE2
+void Scaler::Xbr2xBlock(uint32_t const* frame, std::array<size_t, 5> const& rowOffsets, size_t x,
+                        uint32_t* out0, uint32_t* out1) const
+{
+    // Four pixels at once, x must be at least 2 from the left edge and 5 from the right. The corner rules are worked
+    // out for all of them together as in Xbr2xCorner, then blended one pixel at a time where they found an edge.
+    constexpr size_t B = 7, C = 8, D = 11, E = 12, F = 13, F4 = 14, G = 16, H = 17, I = 18, I4 = 19, H5 = 22, I5 = 23;
+
+    __m128i e = Load(frame + rowOffsets[2] + x);
+    __m128i sameB = _mm_cmpeq_epi32(Load(frame + rowOffsets[1] + x), e);
+    __m128i sameD = _mm_cmpeq_epi32(Load(frame + rowOffsets[2] + x - 1), e);
+    __m128i sameF = _mm_cmpeq_epi32(Load(frame + rowOffsets[2] + x + 1), e);
+    __m128i sameH = _mm_cmpeq_epi32(Load(frame + rowOffsets[3] + x), e);
+    __m128i flat = _mm_and_si128(_mm_and_si128(_mm_or_si128(sameH, sameF), _mm_or_si128(sameD, sameH)),
+                                 _mm_and_si128(_mm_or_si128(sameB, sameD), _mm_or_si128(sameF, sameB)));
+
+    if (MoveMask(flat) == 0x0F)
+    {
+        Store(out0 + (x * 2), _mm_unpacklo_epi32(e, e));
+        Store(out0 + (x * 2) + 4, _mm_unpackhi_epi32(e, e));
+        Store(out1 + (x * 2), _mm_unpacklo_epi32(e, e));
+        Store(out1 + (x * 2) + 4, _mm_unpackhi_epi32(e, e));
+        return;
+    }
+
+    __m128i pixels[GRID_SIZE];
+    __m128i yuv[GRID_SIZE];
+
+    for (size_t gridRow = 0; gridRow < 5; ++gridRow)
+    {
+        for (int dx = -2; dx <= 2; ++dx)
+        {
+            size_t i = rowOffsets[gridRow] + x + dx;
+            pixels[(gridRow * 5) + dx + 2] = Load(frame + i);
+            yuv[(gridRow * 5) + dx + 2] = Load(yuv_.get() + i);
+        }
+    }
+
+    std::array<std::array<uint8_t, 4>, 4> corners {};  // For each pixel, then each rotation
+    int anyEdge = 0;
+
+    for (size_t turn = 0; turn < GRID_ROTATIONS.size(); ++turn)
+    {
+        GridRotation const& rotation = GRID_ROTATIONS[turn];
+        auto pixel = [&](size_t position) { return pixels[rotation[position]]; };
+        auto same = [&](size_t a, size_t b) { return _mm_cmpeq_epi32(pixel(a), pixel(b)); };
+        auto distance = [&](size_t a, size_t b) { return YuvDistance4(yuv[rotation[a]], yuv[rotation[b]]); };
+
+        __m128i alongEdge = _mm_add_epi32(_mm_add_epi32(distance(E, C), distance(E, G)),
+                                          _mm_add_epi32(distance(I, H5), distance(I, F4)));
+        alongEdge = _mm_add_epi32(alongEdge, _mm_slli_epi32(distance(H, F), 2));
+        __m128i acrossEdge = _mm_add_epi32(_mm_add_epi32(distance(H, D), distance(H, I5)),
+                                           _mm_add_epi32(distance(F, I4), distance(F, B)));
+        acrossEdge = _mm_add_epi32(acrossEdge, _mm_slli_epi32(distance(E, I), 2));
+
+        __m128i skip = _mm_or_si128(same(E, H), same(E, F));
+        int edge = MoveMask(_mm_andnot_si128(skip, _mm_cmplt_epi32(alongEdge, acrossEdge)));
+
+        if (edge == 0)
+        {
+            continue;
+        }
+
+        __m128i shallow = distance(F, G);
+        __m128i steep = distance(H, C);
+        int towardF = MoveMask(_mm_cmpgt_epi32(distance(E, F), distance(E, H))) ^ 0x0F;
+        int left = MoveMask(_mm_or_si128(_mm_cmpgt_epi32(_mm_slli_epi32(shallow, 1), steep),
+                                         _mm_or_si128(same(E, G), same(D, G)))) ^ 0x0F;
+        int up = MoveMask(_mm_or_si128(_mm_cmplt_epi32(shallow, _mm_slli_epi32(steep, 1)),
+                                       _mm_or_si128(same(E, C), same(B, C)))) ^ 0x0F;
+
+        for (size_t lane = 0; lane < 4; ++lane)
+        {
+            if (((edge >> lane) & 0x01) != 0)
+            {
+                corners[lane][turn] = XBR_EDGE | ((((left >> lane) & 0x01) != 0) ? XBR_LEFT : 0) |
+                                      ((((up >> lane) & 0x01) != 0) ? XBR_UP : 0) |
+                                      ((((towardF >> lane) & 0x01) != 0) ? XBR_TOWARD_F : 0);
+            }
+        }
+
+        anyEdge |= edge;
+    }
+
+    std::array<std::array<uint32_t, 4>, GRID_SIZE> lanes;
+    std::array<uint32_t, GRID_SIZE> gridPixels;
+    std::array<uint32_t, 4> block;
+
+    for (size_t position = 0; position < GRID_SIZE; ++position)
+    {
+        Store(lanes[position].data(), pixels[position]);
+    }
+
+    for (size_t lane = 0; lane < 4; ++lane)
+    {
+        block.fill(lanes[E][lane]);
+
+        if (((anyEdge >> lane) & 0x01) != 0)
+        {
+            for (size_t position = 0; position < GRID_SIZE; ++position)
+            {
+                gridPixels[position] = lanes[position][lane];
+            }
+
+            for (size_t turn = 0; turn < GRID_ROTATIONS.size(); ++turn)
+            {
+                BlendXbr2xCorner(corners[lane][turn], gridPixels, GRID_ROTATIONS[turn], block);
+            }
+        }
+
+        size_t column = (x + lane) * 2;
+        out0[column] = block[0];
+        out0[column + 1] = block[1];
+        out1[column] = block[2];
+        out1[column + 1] = block[3];
+    }
+}
+#endif
+
+constexpr std::array<Scaler::GridRotation, 4> Scaler::CreateGridRotations()
+{
+    // Each rotation turns the grid another 90 degrees. Grid positions are (dy + 2) * 5 + (dx + 2) around the pixel
+    // being scaled, and output block positions are 0-3 from top left to bottom right.
+    std::array<GridRotation, 4> rotations {};
+
+    auto rotate = [](int& x, int& y, size_t turns)
+    {
+        for (size_t i = 0; i < turns; ++i)
+        {
+            int oldX = x;
+            x = -y;
+            y = oldX;
+        }
+    };
+
+    for (size_t turns = 0; turns < 4; ++turns)
+    {
+        for (int dy = -2; dy <= 2; ++dy)
+        {
+            for (int dx = -2; dx <= 2; ++dx)
+            {
+                int x = dx;
+                int y = dy;
+                rotate(x, y, turns);
+                rotations[turns][((dy + 2) * 5) + dx + 2] = ((y + 2) * 5) + x + 2;
+            }
+        }
+
+        for (size_t corner = 0; corner < 4; ++corner)
+        {
+            int x = ((corner & 0x01) != 0) ? 1 : -1;
+            int y = ((corner & 0x02) != 0) ? 1 : -1;
+            rotate(x, y, turns);
+            rotations[turns][GRID_SIZE + corner] = ((y > 0) ? 2 : 0) + ((x > 0) ? 1 : 0);
+        }
+    }
+
+    return rotations;
+}
+
+constexpr std::array<Scaler::GridRotation, 4> Scaler::GRID_ROTATIONS = Scaler::CreateGridRotations();
+
+uint32_t Scaler::YuvDistance(uint32_t a, uint32_t b)
+{
+    auto difference = [=](int shift) { return std::abs(int((a >> shift) & 0xFF) - int((b >> shift) & 0xFF)); };
+    return (48 * difference(16)) + (7 * difference(8)) + (6 * difference(0));
+}
+
+uint32_t Scaler::Blend(uint32_t a, uint32_t b, uint32_t weight)
+{
+    // Mix weight / 256 of b into a, two channels at a time
+    uint32_t redBlue = ((((a & 0x00FF00FF) * (256 - weight)) + ((b & 0x00FF00FF) * weight)) >> 8) & 0x00FF00FF;
+    uint32_t greenAlpha = ((((a >> 8) & 0x00FF00FF) * (256 - weight)) + (((b >> 8) & 0x00FF00FF) * weight)) & 0xFF00FF00;
+    return redBlue | greenAlpha;
+}
+
+uint8_t Scaler::Xbr2xCorner(std::array<uint32_t, GRID_SIZE> const& pixels,
+                            std::array<uint32_t, GRID_SIZE> const& yuv,
+                            GridRotation const& rotation)
+{
+    // Finds whether E sits on the inside of an edge running across the bottom right corner, and how BlendXbr2xCorner
+    // should blend the bottom right of the output block toward F or H. Grid positions, before rotation:
+    //
+    //          A1  B1  C1
+    //      A0  A   B   C   C4
+    //      D0  D   E   F   F4
+    //      G0  G   H   I   I4
+    //          G5  H5  I5
+    constexpr size_t B = 7, C = 8, D = 11, E = 12, F = 13, F4 = 14, G = 16, H = 17, I = 18, I4 = 19, H5 = 22, I5 = 23;
+
+    auto pixel = [&](size_t position) { return pixels[rotation[position]]; };
+    auto distance = [&](size_t a, size_t b) { return YuvDistance(yuv[rotation[a]], yuv[rotation[b]]); };
+
+    if ((pixel(E) == pixel(H)) || (pixel(E) == pixel(F)))
+    {
+        return 0;
+    }
+
+    // Edge strength along the H-F diagonal versus across it along E-I
+    uint32_t alongEdge = distance(E, C) + distance(E, G) + distance(I, H5) + distance(I, F4) + (distance(H, F) * 4);
+    uint32_t acrossEdge = distance(H, D) + distance(H, I5) + distance(F, I4) + distance(F, B) + (distance(E, I) * 4);
+
+    if (alongEdge >= acrossEdge)
+    {
+        return 0;
+    }
+
+    uint32_t shallow = distance(F, G);
+    uint32_t steep = distance(H, C);
+    bool left = ((shallow * 2) <= steep) && (pixel(E) != pixel(G)) && (pixel(D) != pixel(G));
+    bool up = (shallow >= (steep * 2)) && (pixel(E) != pixel(C)) && (pixel(B) != pixel(C));
+    bool towardF = (distance(E, F) <= distance(E, H));
+
+    return XBR_EDGE | (left ? XBR_LEFT : 0) | (up ? XBR_UP : 0) | (towardF ? XBR_TOWARD_F : 0);
+}
+
+void Scaler::BlendXbr2xCorner(uint8_t corner,
+                              std::array<uint32_t, GRID_SIZE> const& pixels,
+                              GridRotation const& rotation,
+                              std::array<uint32_t, 4>& block)
+{
+    constexpr size_t F = 13, H = 17;
+
+    if ((corner & XBR_EDGE) == 0)
+    {
+        return;
+    }
+
+    uint32_t color = ((corner & XBR_TOWARD_F) != 0) ? pixels[rotation[F]] : pixels[rotation[H]];
+    bool left = (corner & XBR_LEFT) != 0;
+    bool up = (corner & XBR_UP) != 0;
+
+    uint32_t& topRight = block[rotation[GRID_SIZE + 1]];
+    uint32_t& bottomLeft = block[rotation[GRID_SIZE + 2]];
+    uint32_t& bottomRight = block[rotation[GRID_SIZE + 3]];
+
+    if (left && up)
+    {
+        bottomRight = Blend(bottomRight, color, 224);
+        bottomLeft = Blend(bottomLeft, color, 64);
+        topRight = bottomLeft;
+    }
+    else if (left)
+    {
+        bottomRight = Blend(bottomRight, color, 192);
+        bottomLeft = Blend(bottomLeft, color, 64);
+    }
+    else if (up)
+    {
+        bottomRight = Blend(bottomRight, color, 192);
+        topRight = Blend(topRight, color, 64);
+    }
+    else
+    {
+        bottomRight = Blend(bottomRight, color, 128);
+    }
+}
@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
+#include <limits>
 
 TriangleChannel::TriangleChannel()
 {
@@ -28,7 +29,7 @@ void TriangleChannel::Reset()
     timer_ = 0;
 }
 
-uint8_t TriangleChannel::GetOutput()
+uint8_t TriangleChannel::GetOutput() const
 {
     if (timerReload_ < 2)
     {
@@ -65,6 +66,37 @@ void TriangleChannel::Clock()
     }
 }
 
+void TriangleChannel::Run(int clocks)
+{
+    // Same as clocks calls to Clock()
+    if (clocks <= timer_)
+    {
+        timer_ -= clocks;
+        return;
+    }
+
+    clocks -= timer_ + 1;
+    int period = timerReload_ + 1;
+
+    if ((lengthCounter_ > 0) && (linearCounter_ > 0))
+    {
+        sequencerIndex_ = (sequencerIndex_ + 1 + (clocks / period)) % 32;
+    }
+
+    timer_ = timerReload_ - (clocks % period);
+}
+
+int TriangleChannel::ClocksUntilOutputChange() const
+{
+    // Ultrasonic periods are output as silence
+    if ((timerReload_ < 2) || (lengthCounter_ == 0) || (linearCounter_ == 0))
+    {
+        return std::numeric_limits<int>::max();
+    }
+
+    return timer_ + 1;
+}
+
 void TriangleChannel::HalfFrameClock()
 {
     QuarterFrameClock();
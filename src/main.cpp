@@ -1,7 +1,6 @@
 #include "../include/GameWindow.hpp"
 #include "../include/NES.hpp"
 #include "../include/Paths.hpp"
-#include <array>
 #include <filesystem>
 #include <fstream>
 
@@ -22,13 +21,10 @@ int main(int argc, char** argv)
         std::filesystem::create_directory(LOG_PATH);
     }
 
-    std::array<uint8_t, SCREEN_WIDTH * SCREEN_HEIGHT * CHANNELS> frameBuffer;
-    frameBuffer.fill(0x00);
-
     std::ifstream normalColors(PALETTE_PATH.string() + "ntsc_normal.pal", std::ios::binary);
     std::ifstream grayscaleColors(PALETTE_PATH.string() + "ntsc_grayscale.pal", std::ios::binary);
 
-    NES nes(frameBuffer.data(), normalColors, grayscaleColors);
+    NES nes(normalColors, grayscaleColors);
     std::filesystem::path romPath = "";
 
     if (argc > 1)
@@ -36,7 +32,7 @@ int main(int argc, char** argv)
         romPath = argv[1];
     }
 
-    GameWindow gameWindow(nes, frameBuffer.data(), romPath);
+    GameWindow gameWindow(nes, romPath);
     gameWindow.Run();
 
     return 0;
@@ -8,13 +8,15 @@ AxROM::AxROM(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 {
     LoadROM(rom, header[4], header[5]);
     prgIndex_ = 0;
-    mirrorType_ = MirrorType::SINGLE_LOW;
+    SetMirrorType(MirrorType::SINGLE_LOW);
+    UpdatePrgPages();
 }
 
 void AxROM::Reset()
 {
     prgIndex_ = 0;
-    mirrorType_ = MirrorType::SINGLE_LOW;
+    SetMirrorType(MirrorType::SINGLE_LOW);
+    UpdatePrgPages();
 }
 
 uint8_t AxROM::ReadPRG(uint16_t addr)
@@ -32,14 +34,15 @@ void AxROM::WritePRG(uint16_t addr, uint8_t data)
     if (addr >= 0x8000)
     {
         prgIndex_ = data & AXROM_BANK_SELECT_MASK;
+        UpdatePrgPages();
 
         if ((data & NAMETABLE_MIRRORING_MASK) == NAMETABLE_MIRRORING_MASK)
         {
-            mirrorType_ = MirrorType::SINGLE_HIGH;
+            SetMirrorType(MirrorType::SINGLE_HIGH);
         }
         else
         {
-            mirrorType_ = MirrorType::SINGLE_LOW;
+            SetMirrorType(MirrorType::SINGLE_LOW);
         }
     }
 }
@@ -84,6 +87,8 @@ void AxROM::Deserialize(std::ifstream& saveState)
 {
     saveState.read((char*)&prgIndex_, sizeof(prgIndex_));
     saveState.read((char*)&mirrorType_, sizeof(mirrorType_));
+    SetMirrorType(mirrorType_);
+    UpdatePrgPages();
 
     if (chrRamMode_)
     {
@@ -107,3 +112,11 @@ void AxROM::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
         rom.read((char*)CHR_ROM_.data(), 0x2000);
     }
 }
+
+void AxROM::UpdatePrgPages()
+{
+    for (size_t page = PRG_ROM_PAGE; page < PRG_PAGE_COUNT; ++page)
+    {
+        prgReadPages_[page] = PRG_ROM_BANKS_[prgIndex_].data() + ((page - PRG_ROM_PAGE) * PRG_PAGE_SIZE);
+    }
+}
@@ -10,15 +10,20 @@ CNROM::CNROM(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 {
     if ((header[6] & VERTICAL_MIRRORING_FLAG) == VERTICAL_MIRRORING_FLAG)
     {
-        mirrorType_ = MirrorType::VERTICAL;
+        SetMirrorType(MirrorType::VERTICAL);
     }
     else
     {
-        mirrorType_ = MirrorType::HORIZONTAL;
+        SetMirrorType(MirrorType::HORIZONTAL);
     }
 
     LoadROM(rom, header[4], header[5]);
     chrIndex_ = 0;
+
+    for (size_t page = PRG_ROM_PAGE; page < PRG_PAGE_COUNT; ++page)
+    {
+        prgReadPages_[page] = PRG_ROM_.data() + ((page - PRG_ROM_PAGE) * PRG_PAGE_SIZE);
+    }
 }
 
 void CNROM::Reset()
@@ -39,7 +44,13 @@ uint8_t CNROM::ReadPRG(uint16_t addr)
 void CNROM::WritePRG(uint16_t addr, uint8_t data)
 {
     (void)addr;
-    chrIndex_ = data & 0x03;
+    size_t chrIndex = data & 0x03;
+
+    if (chrIndex != chrIndex_)
+    {
+        chrIndex_ = chrIndex;
+        ChrBanksChanged();
+    }
 }
 
 uint8_t CNROM::ReadCHR(uint16_t addr)
@@ -177,6 +177,8 @@ void MMC1::Deserialize(std::ifstream& saveState)
     saveState.read((char*)&Index_, sizeof(Index_));
     saveState.read((char*)&writeCounter_, sizeof(writeCounter_));
     saveState.read((char*)&mirrorType_, sizeof(mirrorType_));
+    SetMirrorType(mirrorType_);
+    UpdatePrgPages();
 
     if (chrRamMode_)
     {
@@ -242,20 +244,22 @@ void MMC1::UpdateIndices()
     uint8_t mirroring = (Reg_.control & MIRRORING_MASK);
     uint8_t prgMode = ((Reg_.control & PRG_ROM_BANK_MODE) >> 2);
     uint8_t chrMode = ((Reg_.control & CHR_ROM_BANK_MODE) >> 4);
+    size_t chr0 = Index_.chr0;
+    size_t chr1 = Index_.chr1;
 
     switch (mirroring)
     {
         case 0:
-            mirrorType_ = MirrorType::SINGLE_LOW;
+            SetMirrorType(MirrorType::SINGLE_LOW);
             break;
         case 1:
-            mirrorType_ = MirrorType::SINGLE_HIGH;
+            SetMirrorType(MirrorType::SINGLE_HIGH);
             break;
         case 2:
-            mirrorType_ = MirrorType::VERTICAL;
+            SetMirrorType(MirrorType::VERTICAL);
             break;
         case 3:
-            mirrorType_ = MirrorType::HORIZONTAL;
+            SetMirrorType(MirrorType::HORIZONTAL);
             break;
         default:
             break;
@@ -293,4 +297,21 @@ void MMC1::UpdateIndices()
         default:
             break;
     }
+
+    if ((Index_.chr0 != chr0) || (Index_.chr1 != chr1))
+    {
+        ChrBanksChanged();
+    }
+
+    UpdatePrgPages();
+}
+
+void MMC1::UpdatePrgPages()
+{
+    prgReadPages_[PRG_RAM_PAGE] = PRG_RAM_.data();
+    prgWritePages_[PRG_RAM_PAGE] = PRG_RAM_.data();
+    prgReadPages_[PRG_ROM_PAGE] = PRG_ROM_BANKS_[Index_.prg0].data();
+    prgReadPages_[PRG_ROM_PAGE + 1] = PRG_ROM_BANKS_[Index_.prg0].data() + PRG_PAGE_SIZE;
+    prgReadPages_[PRG_ROM_PAGE + 2] = PRG_ROM_BANKS_[Index_.prg1].data();
+    prgReadPages_[PRG_ROM_PAGE + 3] = PRG_ROM_BANKS_[Index_.prg1].data() + PRG_PAGE_SIZE;
 }
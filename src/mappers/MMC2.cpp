@@ -8,11 +8,11 @@ MMC2::MMC2(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 {
     if ((header[6] & VERTICAL_MIRRORING_FLAG) == VERTICAL_MIRRORING_FLAG)
     {
-        mirrorType_ = MirrorType::VERTICAL;
+        SetMirrorType(MirrorType::VERTICAL);
     }
     else
     {
-        mirrorType_ = MirrorType::HORIZONTAL;
+        SetMirrorType(MirrorType::HORIZONTAL);
     }
 
     size_t prgRomBanksCount = header[4] * 2;
@@ -29,6 +29,7 @@ MMC2::MMC2(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 
     chrIndex0_ = 0;
     chrIndex1_ = 1;
+    UpdatePrgPages();
 }
 
 void MMC2::Reset()
@@ -36,6 +37,7 @@ void MMC2::Reset()
     prgIndex_[0] = 0;
     chrIndex0_ = 0;
     chrIndex1_ = 1;
+    UpdatePrgPages();
 }
 
 uint8_t MMC2::ReadPRG(uint16_t addr)
@@ -52,31 +54,28 @@ void MMC2::WritePRG(uint16_t addr, uint8_t data)
     {
         case 2:  // PRG ROM bank select ($A000-$AFFF)
             prgIndex_[0] = data & MMC2_PRG_BANK_SELECT_MASK;
+            UpdatePrgPages();
             break;
         case 3:  // CHR ROM $FD/0000 bank select ($B000-$BFFF)
-            leftBankFD_ = data & MMC2_CHR_BANK_SELECT_MASK;
-            UpdateChrBanks();
+            SetChrBank(leftBankFD_, data);
             break;
         case 4:  // CHR ROM $FE/0000 bank select ($C000-$CFFF)
-            leftBankFE_ = data & MMC2_CHR_BANK_SELECT_MASK;
-            UpdateChrBanks();
+            SetChrBank(leftBankFE_, data);
             break;
         case 5:  // CHR ROM $FD/1000 bank select ($D000-$DFFF)
-            rightBankFD_ = data & MMC2_CHR_BANK_SELECT_MASK;
-            UpdateChrBanks();
+            SetChrBank(rightBankFD_, data);
             break;
         case 6:  // CHR ROM $FE/1000 bank select ($E000-$EFFF)
-            rightBankFE_ = data & MMC2_CHR_BANK_SELECT_MASK;
-            UpdateChrBanks();
+            SetChrBank(rightBankFE_, data);
             break;
         case 7:  // Mirroring ($F000-$FFFF)
             if ((data & MMC2_MIRRORING_SELECT_MASK) == MMC2_MIRRORING_SELECT_MASK)
             {
-                mirrorType_ = MirrorType::HORIZONTAL;
+                SetMirrorType(MirrorType::HORIZONTAL);
             }
             else
             {
-                mirrorType_ = MirrorType::VERTICAL;
+                SetMirrorType(MirrorType::VERTICAL);
             }
             break;
         default:
@@ -181,6 +180,8 @@ void MMC2::Deserialize(std::ifstream& saveState)
     saveState.read((char*)&rightBankFD_, sizeof(rightBankFD_));
     saveState.read((char*)&rightBankFE_, sizeof(rightBankFE_));
     saveState.read((char*)&mirrorType_, sizeof(mirrorType_));
+    SetMirrorType(mirrorType_);
+    UpdatePrgPages();
 }
 
 void MMC2::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
@@ -199,6 +200,19 @@ void MMC2::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
     }
 }
 
+void MMC2::SetChrBank(uint8_t& bank, uint8_t data)
+{
+    // A bank the latch isn't on yet still counts as a change, since the PPU's own reads can switch to it
+    uint8_t newBank = data & MMC2_CHR_BANK_SELECT_MASK;
+
+    if (newBank != bank)
+    {
+        bank = newBank;
+        UpdateChrBanks();
+        ChrBanksChanged();
+    }
+}
+
 void MMC2::UpdateChrBanks()
 {
     if (latch0_ == 0xFD)
@@ -219,3 +233,11 @@ void MMC2::UpdateChrBanks()
         chrIndex1_ = rightBankFE_;
     }
 }
+
+void MMC2::UpdatePrgPages()
+{
+    for (size_t page = PRG_ROM_PAGE; page < PRG_PAGE_COUNT; ++page)
+    {
+        prgReadPages_[page] = PRG_ROM_BANKS_[prgIndex_[page - PRG_ROM_PAGE]].data();
+    }
+}
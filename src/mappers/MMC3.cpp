@@ -26,15 +26,15 @@ MMC3::MMC3(std::ifstream& rom, std::filesystem::path const savePath, std::array<
 
     if ((header[6] & IGNORE_MIRRORING_CONTROL) == IGNORE_MIRRORING_CONTROL)
     {
-        mirrorType_ = MirrorType::QUAD;
+        SetMirrorType(MirrorType::QUAD);
     }
     else if ((header[6] & VERTICAL_MIRRORING_FLAG) == VERTICAL_MIRRORING_FLAG)
     {
-        mirrorType_ = MirrorType::VERTICAL;
+        SetMirrorType(MirrorType::VERTICAL);
     }
     else
     {
-        mirrorType_ = MirrorType::HORIZONTAL;
+        SetMirrorType(MirrorType::HORIZONTAL);
     }
 
     size_t prgRomBanksCount = header[4] * 2;
@@ -140,11 +140,11 @@ void MMC3::WritePRG(uint16_t addr, uint8_t data)
             {
                 if ((data & MMC3_MIRRORING_MASK) == MMC3_MIRRORING_MASK)
                 {
-                    mirrorType_ = MirrorType::HORIZONTAL;
+                    SetMirrorType(MirrorType::HORIZONTAL);
                 }
                 else
                 {
-                    mirrorType_ = MirrorType::VERTICAL;
+                    SetMirrorType(MirrorType::VERTICAL);
                 }
             }
         }
@@ -153,6 +153,7 @@ void MMC3::WritePRG(uint16_t addr, uint8_t data)
             // PRG RAM protect
             ramEnabled_ = ((data & PRG_RAM_CHIP_ENABLE_MASK) == PRG_RAM_CHIP_ENABLE_MASK);
             ramWritesDisabled_ = ((data & WRITE_PROTECTION_MASK) == WRITE_PROTECTION_MASK);
+            UpdatePrgPages();
         }
     }
     else if (addr < 0xE000)
@@ -231,6 +232,19 @@ bool MMC3::IRQ()
     return false;
 }
 
+size_t MMC3::ChrReadsUntilIrq()
+{
+    if (!irqEnable_ || sendInterrupt_)
+    {
+        return SIZE_MAX;
+    }
+
+    // Number of counter clocks until it reaches zero. A clock needs A12 to have been low for more than 12 reads, so after
+    // the next one each clock takes at least 14 reads.
+    size_t clocks = (reloadIrqCounter_ || (irqCounter_ == 0)) ? (irqLatch_ + 1) : irqCounter_;
+    return 1 + ((clocks - 1) * 14);
+}
+
 void MMC3::Serialize(std::ofstream& saveState)
 {
     saveState.write((char*)PRG_RAM_.data(), 0x2000);
@@ -299,6 +313,8 @@ void MMC3::Deserialize(std::ifstream& saveState)
     saveState.read((char*)&sendInterrupt_, sizeof(sendInterrupt_));
     saveState.read((char*)&a12Counter_, sizeof(a12Counter_));
     saveState.read((char*)&mirrorType_, sizeof(mirrorType_));
+    SetMirrorType(mirrorType_);
+    UpdatePrgPages();
 }
 
 void MMC3::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
@@ -361,6 +377,8 @@ void MMC3::SetBanks()
     }
 
     // Set CHR Banks
+    std::array<size_t, 8> const previousChrIndex = chrIndex_;
+
     if (chrBankMode_)
     {
         chrIndex_[0] = bankRegister_[2] % CHR_ROM_BANKS_.size();
@@ -383,6 +401,25 @@ void MMC3::SetBanks()
         chrIndex_[6] = bankRegister_[4] % CHR_ROM_BANKS_.size();
         chrIndex_[7] = bankRegister_[5] % CHR_ROM_BANKS_.size();
     }
+
+    if (chrIndex_ != previousChrIndex)
+    {
+        ChrBanksChanged();
+    }
+
+    UpdatePrgPages();
+}
+
+void MMC3::UpdatePrgPages()
+{
+    // Disabled or write protected PRG RAM is left to ReadPRG/WritePRG
+    prgReadPages_[PRG_RAM_PAGE] = ramEnabled_ ? PRG_RAM_.data() : nullptr;
+    prgWritePages_[PRG_RAM_PAGE] = (ramEnabled_ && !ramWritesDisabled_) ? PRG_RAM_.data() : nullptr;
+
+    for (size_t page = PRG_ROM_PAGE; page < PRG_PAGE_COUNT; ++page)
+    {
+        prgReadPages_[page] = PRG_ROM_BANKS_[prgIndex_[page - PRG_ROM_PAGE]].data();
+    }
 }
 
 void MMC3::CheckA12(uint16_t addr)
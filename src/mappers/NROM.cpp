@@ -8,14 +8,19 @@ NROM::NROM(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 {
     if ((header[6] & VERTICAL_MIRRORING_FLAG) == VERTICAL_MIRRORING_FLAG)
     {
-        mirrorType_ = MirrorType::VERTICAL;
+        SetMirrorType(MirrorType::VERTICAL);
     }
     else
     {
-        mirrorType_ = MirrorType::HORIZONTAL;
+        SetMirrorType(MirrorType::HORIZONTAL);
     }
 
     LoadROM(rom, header[4], header[5]);
+
+    for (size_t page = PRG_ROM_PAGE; page < PRG_PAGE_COUNT; ++page)
+    {
+        prgReadPages_[page] = PRG_ROM_.data() + ((page - PRG_ROM_PAGE) * PRG_PAGE_SIZE);
+    }
 }
 
 void NROM::Reset()
@@ -8,21 +8,23 @@ UxROM::UxROM(std::ifstream& rom, std::array<uint8_t, 16> const& header)
 {
     if ((header[6] & VERTICAL_MIRRORING_FLAG) == VERTICAL_MIRRORING_FLAG)
     {
-        mirrorType_ = MirrorType::VERTICAL;
+        SetMirrorType(MirrorType::VERTICAL);
     }
     else
     {
-        mirrorType_ = MirrorType::HORIZONTAL;
+        SetMirrorType(MirrorType::HORIZONTAL);
     }
 
     LoadROM(rom, header[4], header[5]);
     prgIndex0 = 0;
     prgIndex1 = (PRG_ROM_BANKS_.size() - 1);
+    UpdatePrgPages();
 }
 
 void UxROM::Reset()
 {
     prgIndex0 = 0;
+    UpdatePrgPages();
 }
 
 uint8_t UxROM::ReadPRG(uint16_t addr)
@@ -45,6 +47,7 @@ void UxROM::WritePRG(uint16_t addr, uint8_t data)
 {
     (void)addr;
     prgIndex0 = data & UXROM_BANK_SELECT_MASK;
+    UpdatePrgPages();
 }
 
 uint8_t UxROM::ReadCHR(uint16_t addr)
@@ -90,6 +93,7 @@ void UxROM::Deserialize(std::ifstream& saveState)
 
     saveState.read((char*)&prgIndex0, sizeof(prgIndex0));
     saveState.read((char*)&prgIndex1, sizeof(prgIndex1));
+    UpdatePrgPages();
 }
 
 void UxROM::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
@@ -107,3 +111,11 @@ void UxROM::LoadROM(std::ifstream& rom, size_t prgRomBanks, size_t chrRomBanks)
         rom.read((char*)CHR_ROM_.data(), 0x2000);
     }
 }
+
+void UxROM::UpdatePrgPages()
+{
+    prgReadPages_[PRG_ROM_PAGE] = PRG_ROM_BANKS_[prgIndex0].data();
+    prgReadPages_[PRG_ROM_PAGE + 1] = PRG_ROM_BANKS_[prgIndex0].data() + PRG_PAGE_SIZE;
+    prgReadPages_[PRG_ROM_PAGE + 2] = PRG_ROM_BANKS_[prgIndex1].data();
+    prgReadPages_[PRG_ROM_PAGE + 3] = PRG_ROM_BANKS_[prgIndex1].data() + PRG_PAGE_SIZE;
+}
@@ -0,0 +1,499 @@
+// Headless throughput benchmark. Runs each ROM for a number of frames without a window or audio device and writes the
+// results as JSON.
+// Usage: Benchmark [-f frames] [-o output file] [-l label] [-s] <rom> [rom...]
+//
+// Each ROM is run twice from power on:
+//   1. Through NES::Run with audio drained in blocks of 44.1kHz samples, the way GameWindow drives it. This gives
+//      frames/sec and host ns per CPU cycle.
+//   2. Through NES::RunProfiled, which clocks the components one cycle at a time and times each one's Clock(). The cost
+//      of reading the clock is measured up front and subtracted, but the split is still only a rough guide.
+//
+// The resampler is then timed converting a tone from the APU's internal sample rate to each rate GameWindow offers, in
+// the same blocks, giving host ns per output sample and the share of one core it takes to keep up in real time.
+//
+// With -s, each scaler is also timed on the last frame of the first ROM, once for each power of two thread count up to
+// the number of cores, along with the NTSC filter.
+
+#include "../include/NES.hpp"
+#include "../include/Paths.hpp"
+#include "../include/Resampler.hpp"
+#include "../include/Scaler.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr double AUDIO_SAMPLE_RATE = 44100;
+constexpr double CPU_CLOCK_RATE = 1789773;
+constexpr size_t AUDIO_BLOCK_SAMPLES = 256;
+constexpr double RESAMPLER_INPUT_RATE = 96000;  // APU's internal rate
+constexpr std::array<double, 3> RESAMPLER_OUTPUT_RATES = {44100, 48000, 96000};
+constexpr int RESAMPLER_SECONDS = 20;
+
+constexpr int DEFAULT_FRAMES = 600;
+constexpr int TIMER_CALIBRATION_CALLS = 1000000;
+constexpr int SCALER_ITERATIONS = 200;
+
+struct ComponentResult
+{
+    double nsPerCycle;
+    double share;
+};
+
+struct RomResult
+{
+    std::string rom;
+    bool loaded;
+    int frames;
+    uint64_t cycles;
+    double seconds;
+    double framesPerSecond;
+    uint64_t reusedFrames;  // Frames the PPU didn't need to draw because nothing on screen changed
+    double nsPerCycle;
+    ComponentResult cpu;
+    ComponentResult ppu;
+    ComponentResult apu;
+};
+
+struct ResamplerResult
+{
+    double outputRate;
+    size_t taps;
+    double nsPerSample;
+    double realtimeShare;   // Seconds spent per second of output
+};
+
+struct ScalerResult
+{
+    std::string scaler;
+    size_t threads;
+    double msPerFrame;
+};
+
+std::unique_ptr<NES> CreateNES()
+{
+    std::ifstream normalColors(PALETTE_PATH.string() + "ntsc_normal.pal", std::ios::binary);
+    std::ifstream grayscaleColors(PALETTE_PATH.string() + "ntsc_grayscale.pal", std::ios::binary);
+    return std::make_unique<NES>(normalColors, grayscaleColors);
+}
+
+static std::filesystem::path const SAVE_FILE = std::filesystem::temp_directory_path() / "nes_benchmark.sav";
+
+double TimerOverheadNs()
+{
+    // Average cost of one steady_clock::now() call. Each component interval in RunProfiled includes one.
+    using std::chrono::steady_clock;
+    auto start = steady_clock::now();
+
+    for (int i = 0; i < TIMER_CALIBRATION_CALLS; ++i)
+    {
+        steady_clock::time_point volatile now = steady_clock::now();
+        (void)now;
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = steady_clock::now() - start;
+    return elapsed.count() / TIMER_CALIBRATION_CALLS;
+}
+
+bool LoadRom(NES& nes, std::filesystem::path const& romPath)
+{
+    // Don't pick up battery saves from a previous run
+    std::filesystem::remove(SAVE_FILE);
+    nes.SetControllerInputs(0x00, 0x00);
+    return nes.LoadCartridge(romPath, SAVE_FILE);
+}
+
+void MeasureThroughput(std::filesystem::path const& romPath, RomResult& result)
+{
+    std::unique_ptr<NES> emulator = CreateNES();
+    NES& nes = *emulator;
+
+    if (!LoadRom(nes, romPath))
+    {
+        result.loaded = false;
+        return;
+    }
+
+    std::vector<int16_t> samples(AUDIO_BLOCK_SAMPLES);
+    uint64_t cycles = 0;
+    int frames = 0;
+    auto start = std::chrono::steady_clock::now();
+    nes.SetAudioRates(CPU_CLOCK_RATE, AUDIO_SAMPLE_RATE);
+
+    while (frames < result.frames)
+    {
+        size_t blockCycles = nes.CyclesUntilAudioSamples(samples.size());
+
+        while (blockCycles > 0)
+        {
+            size_t cyclesRun = nes.Run(blockCycles);
+            blockCycles -= cyclesRun;
+            cycles += cyclesRun;
+
+            if (nes.FrameReady())
+            {
+                ++frames;
+            }
+        }
+
+        nes.ReadAudioSamples(samples.data(), samples.size());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    result.loaded = true;
+    result.cycles = cycles;
+    result.seconds = elapsed.count();
+    result.framesPerSecond = frames / result.seconds;
+    result.reusedFrames = nes.GetReusedFrameCount();
+    result.nsPerCycle = (result.seconds * 1e9) / cycles;
+}
+
+void MeasureComponents(std::filesystem::path const& romPath, double timerOverheadNs, RomResult& result)
+{
+    std::unique_ptr<NES> emulator = CreateNES();
+    NES& nes = *emulator;
+
+    if (!LoadRom(nes, romPath))
+    {
+        return;
+    }
+
+    NES::ComponentTimes times;
+    uint64_t cycles = 0;
+    int frames = 0;
+
+    while (frames < result.frames)
+    {
+        cycles += nes.RunProfiled(SIZE_MAX, times);
+
+        if (nes.FrameReady())
+        {
+            ++frames;
+        }
+    }
+
+    auto nsPerCycle = [=](std::chrono::nanoseconds time)
+    {
+        double ns = (static_cast<double>(time.count()) / cycles) - timerOverheadNs;
+        return (ns > 0.0) ? ns : 0.0;
+    };
+
+    result.cpu.nsPerCycle = nsPerCycle(times.cpu);
+    result.ppu.nsPerCycle = nsPerCycle(times.ppu);
+    result.apu.nsPerCycle = nsPerCycle(times.apu);
+
+    double total = result.cpu.nsPerCycle + result.ppu.nsPerCycle + result.apu.nsPerCycle;
+
+    if (total > 0.0)
+    {
+        result.cpu.share = result.cpu.nsPerCycle / total;
+        result.ppu.share = result.ppu.nsPerCycle / total;
+        result.apu.share = result.apu.nsPerCycle / total;
+    }
+}
+
+void MeasureResampler(std::vector<ResamplerResult>& results)
+{
+    // A 440Hz square wave, the content doesn't change the cost
+    std::vector<int16_t> input(RESAMPLER_INPUT_RATE * RESAMPLER_SECONDS);
+
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = (std::fmod(i * 440.0 / RESAMPLER_INPUT_RATE, 1.0) < 0.5) ? 8000 : -8000;
+    }
+
+    for (double outputRate : RESAMPLER_OUTPUT_RATES)
+    {
+        Resampler resampler;
+        resampler.SetRates(RESAMPLER_INPUT_RATE, outputRate);
+
+        std::vector<int16_t> samples(AUDIO_BLOCK_SAMPLES);
+        size_t written = 0;
+        uint64_t read = 0;
+        auto start = std::chrono::steady_clock::now();
+
+        while (true)
+        {
+            size_t needed = resampler.InputNeeded(samples.size());
+
+            if (written + needed > input.size())
+            {
+                break;
+            }
+
+            resampler.Write(input.data() + written, needed);
+            written += needed;
+            read += resampler.Read(samples.data(), samples.size());
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double nsPerSample = (elapsed.count() * 1e9) / read;
+        results.push_back({outputRate, resampler.GetTapCount(), nsPerSample, nsPerSample * outputRate / 1e9});
+    }
+}
+
+void MeasureScalers(std::filesystem::path const& romPath, int frames, std::vector<ScalerResult>& results)
+{
+    std::unique_ptr<NES> emulator = CreateNES();
+    NES& nes = *emulator;
+
+    if (!LoadRom(nes, romPath))
+    {
+        return;
+    }
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        nes.RunUntilFrameReady();
+    }
+
+    std::vector<uint32_t> frame(FRAME_BUFFER_SIZE);
+    nes.ConvertFrame(nes.GetLastFrame(), (uint8_t*)frame.data(), FRAME_WIDTH * sizeof(uint32_t), PixelFormat::BGRA8888);
+
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        Scaler scaler(threads);
+
+        for (size_t type = 1; type < SCALER_COUNT; ++type)
+        {
+            ScalerType scalerType = static_cast<ScalerType>(type);
+            size_t scale = ScaleFactor(scalerType);
+            size_t pitch = FRAME_WIDTH * scale * sizeof(uint32_t);
+            std::vector<uint8_t> pixels(pitch * FRAME_HEIGHT * scale);
+
+            // Once untimed to wake the pool and fault in the output
+            scaler.Scale(scalerType, frame.data(), pixels.data(), pitch);
+            auto start = std::chrono::steady_clock::now();
+
+            for (int i = 0; i < SCALER_ITERATIONS; ++i)
+            {
+                scaler.Scale(scalerType, frame.data(), pixels.data(), pitch);
+            }
+
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            results.push_back({ScalerName(scalerType), threads, elapsed.count() / SCALER_ITERATIONS});
+        }
+    }
+
+    // The NTSC filter works from the palette indexed frame and always runs on one thread
+    std::vector<uint8_t> pixels(NTSC_FRAME_WIDTH * sizeof(uint32_t) * FRAME_HEIGHT);
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < SCALER_ITERATIONS; ++i)
+    {
+        nes.FilterFrame(nes.GetLastFrame(), i % 12, pixels.data(), NTSC_FRAME_WIDTH * sizeof(uint32_t));
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    results.push_back({"NTSC", 1, elapsed.count() / SCALER_ITERATIONS});
+}
+
+std::string JsonString(std::string const& str)
+{
+    std::string escaped = "\"";
+
+    for (char c : str)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            char buffer[8];
+            std::snprintf(buffer, sizeof(buffer), "\\u%04X", c);
+            escaped += buffer;
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped + "\"";
+}
+
+void WriteComponent(FILE* output, char const* name, ComponentResult const& component, bool last)
+{
+    std::fprintf(output, "        \"%s\": {\"nsPerCycle\": %.3f, \"share\": %.4f}%s\n",
+                 name, component.nsPerCycle, component.share, last ? "" : ",");
+}
+
+void WriteJson(FILE* output, std::string const& label, double timerOverheadNs, std::vector<RomResult> const& results,
+               std::vector<ResamplerResult> const& resamplerResults, std::vector<ScalerResult> const& scalerResults)
+{
+    std::fprintf(output, "{\n");
+    std::fprintf(output, "  \"label\": %s,\n", JsonString(label).c_str());
+    std::fprintf(output, "  \"timerOverheadNs\": %.3f,\n", timerOverheadNs);
+    std::fprintf(output, "  \"roms\": [\n");
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        RomResult const& result = results[i];
+        std::fprintf(output, "    {\n");
+        std::fprintf(output, "      \"rom\": %s,\n", JsonString(result.rom).c_str());
+
+        if (!result.loaded)
+        {
+            std::fprintf(output, "      \"error\": \"Unable to load ROM\"\n");
+        }
+        else
+        {
+            std::fprintf(output, "      \"frames\": %d,\n", result.frames);
+            std::fprintf(output, "      \"cycles\": %llu,\n", (unsigned long long)result.cycles);
+            std::fprintf(output, "      \"seconds\": %.6f,\n", result.seconds);
+            std::fprintf(output, "      \"framesPerSecond\": %.2f,\n", result.framesPerSecond);
+            std::fprintf(output, "      \"reusedFrames\": %llu,\n", (unsigned long long)result.reusedFrames);
+            std::fprintf(output, "      \"nsPerCycle\": %.3f,\n", result.nsPerCycle);
+            std::fprintf(output, "      \"components\": {\n");
+            WriteComponent(output, "cpu", result.cpu, false);
+            WriteComponent(output, "ppu", result.ppu, false);
+            WriteComponent(output, "apu", result.apu, true);
+            std::fprintf(output, "      }\n");
+        }
+
+        std::fprintf(output, "    }%s\n", (i + 1 < results.size()) ? "," : "");
+    }
+
+    std::fprintf(output, "  ],\n");
+    std::fprintf(output, "  \"resamplers\": [\n");
+
+    for (size_t i = 0; i < resamplerResults.size(); ++i)
+    {
+        ResamplerResult const& result = resamplerResults[i];
+        std::fprintf(output, "    {\"outputRate\": %.0f, \"taps\": %zu, \"nsPerSample\": %.3f, "
+                     "\"realtimeShare\": %.6f}%s\n",
+                     result.outputRate, result.taps, result.nsPerSample, result.realtimeShare,
+                     (i + 1 < resamplerResults.size()) ? "," : "");
+    }
+
+    std::fprintf(output, "  ]%s\n", scalerResults.empty() ? "" : ",");
+
+    if (!scalerResults.empty())
+    {
+        std::fprintf(output, "  \"scalers\": [\n");
+
+        for (size_t i = 0; i < scalerResults.size(); ++i)
+        {
+            ScalerResult const& result = scalerResults[i];
+            std::fprintf(output, "    {\"scaler\": %s, \"threads\": %zu, \"msPerFrame\": %.3f}%s\n",
+                         JsonString(result.scaler).c_str(), result.threads, result.msPerFrame,
+                         (i + 1 < scalerResults.size()) ? "," : "");
+        }
+
+        std::fprintf(output, "  ]\n");
+    }
+
+    std::fprintf(output, "}\n");
+}
+
+int main(int argc, char** argv)
+{
+    int frames = DEFAULT_FRAMES;
+    char const* outputPath = nullptr;
+    std::string label = "";
+    bool measureScalers = false;
+    std::vector<std::filesystem::path> roms;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if ((arg == "-f") && (i + 1 < argc))
+        {
+            frames = std::atoi(argv[++i]);
+        }
+        else if ((arg == "-o") && (i + 1 < argc))
+        {
+            outputPath = argv[++i];
+        }
+        else if ((arg == "-l") && (i + 1 < argc))
+        {
+            label = argv[++i];
+        }
+        else if (arg == "-s")
+        {
+            measureScalers = true;
+        }
+        else
+        {
+            roms.push_back(arg);
+        }
+    }
+
+    if (roms.empty() || (frames <= 0))
+    {
+        std::cerr << "Usage: " << argv[0] << " [-f frames] [-o output file] [-l label] [-s] <rom> [rom...]\n";
+        return 1;
+    }
+
+    double timerOverheadNs = TimerOverheadNs();
+    std::vector<RomResult> results;
+
+    for (auto const& romPath : roms)
+    {
+        std::cerr << "Running " << romPath.string() << "\n";
+        RomResult result {};
+        result.rom = romPath.filename().string();
+        result.frames = frames;
+        MeasureThroughput(romPath, result);
+
+        if (result.loaded)
+        {
+            MeasureComponents(romPath, timerOverheadNs, result);
+        }
+
+        results.push_back(result);
+    }
+
+    std::cerr << "Timing resampler\n";
+    std::vector<ResamplerResult> resamplerResults;
+    MeasureResampler(resamplerResults);
+
+    std::vector<ScalerResult> scalerResults;
+
+    if (measureScalers && results.front().loaded)
+    {
+        std::cerr << "Timing scalers\n";
+        MeasureScalers(roms.front(), frames, scalerResults);
+    }
+
+    std::filesystem::remove(SAVE_FILE);
+    FILE* output = (outputPath != nullptr) ? std::fopen(outputPath, "w") : stdout;
+
+    if (output == nullptr)
+    {
+        std::cerr << "Unable to open " << outputPath << "\n";
+        return 1;
+    }
+
+    WriteJson(output, label, timerOverheadNs, results, resamplerResults, scalerResults);
+
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    bool allLoaded = true;
+
+    for (auto const& result : results)
+    {
+        allLoaded = allLoaded && result.loaded;
+    }
+
+    return allLoaded ? 0 : 1;
+}
@@ -0,0 +1,339 @@
+// Checks that idle loop skipping doesn't change what the NES does. Each ROM is run twice from power on, with skipping on
+// and off, through NES::Run in blocks of cycles the size GameWindow and the benchmark use. Every completed frame and the
+// final state must match.
+// Usage: IdleSkipCheck [-f frames] [rom...]
+//
+// Small blocks cap every skip at the end of the block, so the block sizes go up to a whole frame. Besides any ROMs given,
+// a built in ROM waits on PPUSTATUS for sprite 0 hit or sprite overflow and turns on grayscale as soon as it sees it,
+// starting each wait in vblank the way status bar splits do. A skip that runs past the flag being set moves the split.
+
+#include "../include/FrameConverter.hpp"
+#include "../include/NES.hpp"
+#include "../include/Paths.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+constexpr int DEFAULT_FRAMES = 120;
+constexpr size_t CYCLES_PER_FRAME = 29781;
+constexpr std::array<size_t, 3> BLOCK_CYCLES = {41, 9545, CYCLES_PER_FRAME};
+
+// NROM-128 program at $C000. Waits for vblank twice, loads the palette, fills the first nametable with an opaque tile,
+// copies OAM from $C200 and the PPUSTATUS flag to wait on from $C120, then turns rendering on and loops.
+constexpr std::array<uint8_t, 134> PROGRAM = {
+    0x78,                               //          SEI
+    0xD8,                               //          CLD
+    0xA2, 0xFF,                         //          LDX #$FF
+    0x9A,                               //          TXS
+    0xE8,                               //          INX
+    0x8E, 0x00, 0x20,                   //          STX $2000
+    0x8E, 0x01, 0x20,                   //          STX $2001
+    0x2C, 0x02, 0x20,                   // vblank1: BIT $2002
+    0x10, 0xFB,                         //          BPL vblank1
+    0x2C, 0x02, 0x20,                   // vblank2: BIT $2002
+    0x10, 0xFB,                         //          BPL vblank2
+    0xA9, 0x3F,                         //          LDA #$3F
+    0x8D, 0x06, 0x20,                   //          STA $2006
+    0xA9, 0x00,                         //          LDA #$00
+    0x8D, 0x06, 0x20,                   //          STA $2006
+    0xBD, 0x00, 0xC1,                   // palette: LDA $C100,X
+    0x8D, 0x07, 0x20,                   //          STA $2007
+    0xE8,                               //          INX
+    0xE0, 0x20,                         //          CPX #$20
+    0xD0, 0xF5,                         //          BNE palette
+    0xA9, 0x20,                         //          LDA #$20
+    0x8D, 0x06, 0x20,                   //          STA $2006
+    0xA9, 0x00,                         //          LDA #$00
+    0x8D, 0x06, 0x20,                   //          STA $2006
+    0xA9, 0x01,                         //          LDA #$01
+    0xA2, 0x00,                         //          LDX #$00
+    0xA0, 0x04,                         //          LDY #$04
+    0x8D, 0x07, 0x20,                   // tiles:   STA $2007
+    0xCA,                               //          DEX
+    0xD0, 0xFA,                         //          BNE tiles
+    0x88,                               //          DEY
+    0xD0, 0xF7,                         //          BNE tiles
+    0x8E, 0x03, 0x20,                   //          STX $2003
+    0xBD, 0x00, 0xC2,                   // oam:     LDA $C200,X
+    0x8D, 0x04, 0x20,                   //          STA $2004
+    0xE8,                               //          INX
+    0xD0, 0xF7,                         //          BNE oam
+    0xAD, 0x20, 0xC1,                   //          LDA $C120
+    0x85, 0x00,                         //          STA $00
+    0x8E, 0x05, 0x20,                   //          STX $2005
+    0x8E, 0x05, 0x20,                   //          STX $2005
+    0x2C, 0x02, 0x20,                   // vblank3: BIT $2002
+    0x10, 0xFB,                         //          BPL vblank3
+    0xA9, 0x1E,                         //          LDA #$1E
+    0x8D, 0x01, 0x20,                   //          STA $2001
+    0xAD, 0x02, 0x20,                   // clear:   LDA $2002       Wait for the flag from the last frame to clear
+    0x25, 0x00,                         //          AND $00
+    0xD0, 0xF9,                         //          BNE clear
+    0xAD, 0x02, 0x20,                   // set:     LDA $2002       Then for it to be set again
+    0x25, 0x00,                         //          AND $00
+    0xF0, 0xF9,                         //          BEQ set
+    0xA9, 0x1F,                         //          LDA #$1F        Grayscale from here down
+    0x8D, 0x01, 0x20,                   //          STA $2001
+    0xAD, 0x02, 0x20,                   // vblank:  LDA $2002
+    0x10, 0xFB,                         //          BPL vblank
+    0xA9, 0x1E,                         //          LDA #$1E
+    0x8D, 0x01, 0x20,                   //          STA $2001
+    0x4C, 0x65, 0xC0,                   //          JMP clear
+    0x40                                // $C085:   RTI             NMI and IRQ
+};
+
+constexpr size_t PALETTE_OFFSET = 0x0100;
+constexpr size_t FLAG_OFFSET = 0x0120;
+constexpr size_t OAM_OFFSET = 0x0200;
+constexpr uint16_t RTI_ADDRESS = 0xC085;
+
+constexpr uint8_t SPRITE_0_HIT_FLAG = 0x40;
+constexpr uint8_t SPRITE_OVERFLOW_FLAG = 0x20;
+
+struct TestRom
+{
+    std::string name;
+    uint8_t flag;
+    std::vector<std::array<uint8_t, 4>> sprites;    // Y, tile, attributes, X. The rest of OAM is off screen.
+};
+
+std::vector<uint8_t> BuildRom(TestRom const& rom)
+{
+    std::vector<uint8_t> prg(0x4000, 0x00);
+    std::copy(PROGRAM.begin(), PROGRAM.end(), prg.begin());
+
+    // Black backdrop, with white for the background's tile and red for sprites
+    for (size_t i = 0; i < 32; ++i)
+    {
+        prg[PALETTE_OFFSET + i] = ((i % 4) == 0) ? 0x0F : ((i < 16) ? 0x30 : 0x16);
+    }
+
+    prg[FLAG_OFFSET] = rom.flag;
+    std::fill(prg.begin() + OAM_OFFSET, prg.begin() + OAM_OFFSET + 256, 0xFF);
+
+    for (size_t sprite = 0; sprite < rom.sprites.size(); ++sprite)
+    {
+        std::copy(rom.sprites[sprite].begin(), rom.sprites[sprite].end(), prg.begin() + OAM_OFFSET + (sprite * 4));
+    }
+
+    for (size_t vector = 0x3FFA; vector < 0x4000; vector += 2)
+    {
+        prg[vector] = RTI_ADDRESS & 0xFF;
+        prg[vector + 1] = RTI_ADDRESS >> 8;
+    }
+
+    prg[0x3FFC] = 0x00;
+    prg[0x3FFD] = 0xC0;
+
+    // Tile 1 is solid color 1
+    std::vector<uint8_t> chr(0x2000, 0x00);
+    std::fill(chr.begin() + 0x10, chr.begin() + 0x18, 0xFF);
+
+    std::vector<uint8_t> image = {'N', 'E', 'S', 0x1A, 0x01, 0x01, 0x00, 0x00};
+    image.resize(16, 0x00);
+    image.insert(image.end(), prg.begin(), prg.end());
+    image.insert(image.end(), chr.begin(), chr.end());
+    return image;
+}
+
+std::unique_ptr<NES> CreateNES()
+{
+    std::ifstream normalColors(PALETTE_PATH.string() + "ntsc_normal.pal", std::ios::binary);
+    std::ifstream grayscaleColors(PALETTE_PATH.string() + "ntsc_grayscale.pal", std::ios::binary);
+    return std::make_unique<NES>(normalColors, grayscaleColors);
+}
+
+// Some components save themselves as raw copies of their objects, padding included, so everything is allocated zeroed
+// for the final states of two runs to compare byte for byte
+void* operator new(size_t size)
+{
+    void* memory = std::calloc(1, (size != 0) ? size : 1);
+
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+static std::filesystem::path const TEMP_PATH = std::filesystem::temp_directory_path();
+
+struct RunResult
+{
+    bool loaded;
+    std::vector<std::vector<uint16_t>> frames;
+    std::vector<char> state;
+};
+
+RunResult RunRom(std::filesystem::path const& romPath, bool idleLoopSkipping, size_t blockCycles, int frames)
+{
+    RunResult result {};
+    std::unique_ptr<NES> emulator = CreateNES();
+    NES& nes = *emulator;
+
+    // Don't pick up battery saves from a previous run
+    std::filesystem::path savePath = TEMP_PATH / "nes_idle_skip_check.sav";
+    std::filesystem::remove(savePath);
+    nes.SetControllerInputs(0x00, 0x00);
+    result.loaded = nes.LoadCartridge(romPath, savePath);
+
+    if (!result.loaded)
+    {
+        return result;
+    }
+
+    nes.SetIdleLoopSkipping(idleLoopSkipping);
+
+    for (size_t cycles = 0; cycles < frames * CYCLES_PER_FRAME; cycles += blockCycles)
+    {
+        size_t remaining = blockCycles;
+
+        while (remaining > 0)
+        {
+            remaining -= nes.Run(remaining);
+
+            if (nes.FrameReady())
+            {
+                uint16_t const* frame = nes.GetLastFrame();
+                result.frames.emplace_back(frame, frame + FRAME_BUFFER_SIZE);
+            }
+        }
+    }
+
+    std::filesystem::path statePath = TEMP_PATH / "nes_idle_skip_check.state";
+
+    {
+        std::ofstream saveState(statePath, std::ios::binary);
+        nes.RunUntilSerializable();
+        nes.Serialize(saveState);
+    }
+
+    std::ifstream saveState(statePath, std::ios::binary);
+    result.state.assign(std::istreambuf_iterator<char>(saveState), std::istreambuf_iterator<char>());
+    saveState.close();
+    std::filesystem::remove(statePath);
+    std::filesystem::remove(savePath);
+    return result;
+}
+
+bool Compare(std::string const& name, std::filesystem::path const& romPath, int frames)
+{
+    bool passed = true;
+
+    for (size_t blockCycles : BLOCK_CYCLES)
+    {
+        RunResult skipped = RunRom(romPath, true, blockCycles, frames);
+        RunResult stepped = RunRom(romPath, false, blockCycles, frames);
+        std::cout << std::dec << name << ", " << blockCycles << " cycle blocks: ";
+
+        if (!skipped.loaded || !stepped.loaded)
+        {
+            std::cout << "unable to load ROM\n";
+            return false;
+        }
+
+        size_t frameCount = std::min(skipped.frames.size(), stepped.frames.size());
+        auto mismatch = std::mismatch(skipped.frames.begin(), skipped.frames.begin() + frameCount, stepped.frames.begin());
+
+        if (mismatch.first != skipped.frames.begin() + frameCount)
+        {
+            // Report the first row that differs, which is where a status bar split landed in the wrong place
+            auto pixel = std::mismatch(mismatch.first->begin(), mismatch.first->end(), mismatch.second->begin());
+            std::cout << "frame " << (mismatch.first - skipped.frames.begin()) << " differs from row "
+                      << ((pixel.first - mismatch.first->begin()) / FRAME_WIDTH) << "\n";
+            passed = false;
+        }
+        else if (skipped.frames.size() != stepped.frames.size())
+        {
+            std::cout << skipped.frames.size() << " frames completed instead of " << stepped.frames.size() << "\n";
+            passed = false;
+        }
+        else if (skipped.state != stepped.state)
+        {
+            std::cout << "final state differs\n";
+            passed = false;
+        }
+        else
+        {
+            std::cout << "OK\n";
+        }
+    }
+
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    int frames = DEFAULT_FRAMES;
+    std::vector<std::filesystem::path> roms;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+
+        if ((arg == "-f") && (i + 1 < argc))
+        {
+            frames = std::atoi(argv[++i]);
+        }
+        else
+        {
+            roms.push_back(arg);
+        }
+    }
+
+    if (frames <= 0)
+    {
+        std::cerr << "Usage: " << argv[0] << " [-f frames] [rom...]\n";
+        return 1;
+    }
+
+    std::vector<TestRom> const testRoms = {
+        {"Sprite 0 hit on line 31", SPRITE_0_HIT_FLAG, {{30, 0x01, 0x00, 100}}},
+        {"Sprite 0 hit on line 101", SPRITE_0_HIT_FLAG, {{100, 0x01, 0x00, 100}}},
+        {"Sprite overflow on line 61", SPRITE_OVERFLOW_FLAG, {{0xFF, 0x01, 0x00, 0},
+                                                              {60, 0x01, 0x00, 0}, {60, 0x01, 0x00, 16},
+                                                              {60, 0x01, 0x00, 32}, {60, 0x01, 0x00, 48},
+                                                              {60, 0x01, 0x00, 64}, {60, 0x01, 0x00, 80},
+                                                              {60, 0x01, 0x00, 96}, {60, 0x01, 0x00, 112},
+                                                              {60, 0x01, 0x00, 128}}}
+    };
+
+    bool passed = true;
+    std::filesystem::path testRomPath = TEMP_PATH / "nes_idle_skip_check.nes";
+
+    for (TestRom const& testRom : testRoms)
+    {
+        std::vector<uint8_t> image = BuildRom(testRom);
+        std::ofstream(testRomPath, std::ios::binary).write((char const*)image.data(), image.size());
+        passed = Compare(testRom.name, testRomPath, frames) && passed;
+    }
+
+    std::filesystem::remove(testRomPath);
+
+    for (auto const& romPath : roms)
+    {
+        passed = Compare(romPath.filename().string(), romPath, frames) && passed;
+    }
+
+    return passed ? 0 : 1;
+}
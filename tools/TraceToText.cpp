@@ -0,0 +1,338 @@
+// Renders a binary CPU trace written by CpuTrace as nestest-style text.
+// Usage: TraceToText <trace file> [output file]
+
+#include "../include/CpuTrace.hpp"
+#include "../include/OpCodes.hpp"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+enum class Mode : uint8_t
+{
+    INVALID,
+    ABSOLUTE,
+    ABSOLUTE_X,
+    ABSOLUTE_Y,
+    ACCUMULATOR,
+    IMMEDIATE,
+    IMPLIED,
+    INDIRECT,
+    INDIRECT_X,
+    INDIRECT_Y,
+    RELATIVE,
+    ZERO_PAGE,
+    ZERO_PAGE_X,
+    ZERO_PAGE_Y
+};
+
+struct Disassembly
+{
+    char const* mnemonic = "???";
+    Mode mode = Mode::INVALID;
+};
+
+struct OpCodeEntry
+{
+    OpCode opCode;
+    char const* mnemonic;
+    Mode mode;
+};
+
+static std::array<Disassembly, 256> CreateDisassemblyTable()
+{
+    static const OpCodeEntry OPCODES[] = {
+        {OpCode::Immediate_ADC,    "ADC", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_ADC,     "ADC", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_ADC,   "ADC", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_ADC,     "ADC", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_ADC,   "ADC", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_ADC,   "ADC", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_ADC,   "ADC", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_ADC,   "ADC", Mode::INDIRECT_Y},
+        {OpCode::Immediate_AND,    "AND", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_AND,     "AND", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_AND,   "AND", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_AND,     "AND", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_AND,   "AND", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_AND,   "AND", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_AND,   "AND", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_AND,   "AND", Mode::INDIRECT_Y},
+        {OpCode::Accumulator_ASL,  "ASL", Mode::ACCUMULATOR},
+        {OpCode::ZeroPage_ASL,     "ASL", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_ASL,   "ASL", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_ASL,     "ASL", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_ASL,   "ASL", Mode::ABSOLUTE_X},
+        {OpCode::Relative_BCC,     "BCC", Mode::RELATIVE},
+        {OpCode::Relative_BCS,     "BCS", Mode::RELATIVE},
+        {OpCode::Relative_BEQ,     "BEQ", Mode::RELATIVE},
+        {OpCode::ZeroPage_BIT,     "BIT", Mode::ZERO_PAGE},
+        {OpCode::Absolute_BIT,     "BIT", Mode::ABSOLUTE},
+        {OpCode::Relative_BMI,     "BMI", Mode::RELATIVE},
+        {OpCode::Relative_BNE,     "BNE", Mode::RELATIVE},
+        {OpCode::Relative_BPL,     "BPL", Mode::RELATIVE},
+        {OpCode::Implied_BRK,      "BRK", Mode::IMPLIED},
+        {OpCode::Relative_BVC,     "BVC", Mode::RELATIVE},
+        {OpCode::Relative_BVS,     "BVS", Mode::RELATIVE},
+        {OpCode::Implied_CLC,      "CLC", Mode::IMPLIED},
+        {OpCode::Implied_CLD,      "CLD", Mode::IMPLIED},
+        {OpCode::Implied_CLI,      "CLI", Mode::IMPLIED},
+        {OpCode::Implied_CLV,      "CLV", Mode::IMPLIED},
+        {OpCode::Immediate_CMP,    "CMP", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_CMP,     "CMP", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_CMP,   "CMP", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_CMP,     "CMP", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_CMP,   "CMP", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_CMP,   "CMP", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_CMP,   "CMP", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_CMP,   "CMP", Mode::INDIRECT_Y},
+        {OpCode::Immediate_CPX,    "CPX", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_CPX,     "CPX", Mode::ZERO_PAGE},
+        {OpCode::Absolute_CPX,     "CPX", Mode::ABSOLUTE},
+        {OpCode::Immediate_CPY,    "CPY", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_CPY,     "CPY", Mode::ZERO_PAGE},
+        {OpCode::Absolute_CPY,     "CPY", Mode::ABSOLUTE},
+        {OpCode::ZeroPage_DEC,     "DEC", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_DEC,   "DEC", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_DEC,     "DEC", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_DEC,   "DEC", Mode::ABSOLUTE_X},
+        {OpCode::Implied_DEX,      "DEX", Mode::IMPLIED},
+        {OpCode::Implied_DEY,      "DEY", Mode::IMPLIED},
+        {OpCode::Immediate_EOR,    "EOR", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_EOR,     "EOR", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_EOR,   "EOR", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_EOR,     "EOR", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_EOR,   "EOR", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_EOR,   "EOR", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_EOR,   "EOR", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_EOR,   "EOR", Mode::INDIRECT_Y},
+        {OpCode::ZeroPage_INC,     "INC", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_INC,   "INC", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_INC,     "INC", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_INC,   "INC", Mode::ABSOLUTE_X},
+        {OpCode::Implied_INX,      "INX", Mode::IMPLIED},
+        {OpCode::Implied_INY,      "INY", Mode::IMPLIED},
+        {OpCode::Absolute_JMP,     "JMP", Mode::ABSOLUTE},
+        {OpCode::Indirect_JMP,     "JMP", Mode::INDIRECT},
+        {OpCode::Absolute_JSR,     "JSR", Mode::ABSOLUTE},
+        {OpCode::Immediate_LDA,    "LDA", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_LDA,     "LDA", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_LDA,   "LDA", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_LDA,     "LDA", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_LDA,   "LDA", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_LDA,   "LDA", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_LDA,   "LDA", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_LDA,   "LDA", Mode::INDIRECT_Y},
+        {OpCode::Immediate_LDX,    "LDX", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_LDX,     "LDX", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_Y_LDX,   "LDX", Mode::ZERO_PAGE_Y},
+        {OpCode::Absolute_LDX,     "LDX", Mode::ABSOLUTE},
+        {OpCode::Absolute_Y_LDX,   "LDX", Mode::ABSOLUTE_Y},
+        {OpCode::Immediate_LDY,    "LDY", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_LDY,     "LDY", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_LDY,   "LDY", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_LDY,     "LDY", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_LDY,   "LDY", Mode::ABSOLUTE_X},
+        {OpCode::Accumulator_LSR,  "LSR", Mode::ACCUMULATOR},
+        {OpCode::ZeroPage_LSR,     "LSR", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_LSR,   "LSR", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_LSR,     "LSR", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_LSR,   "LSR", Mode::ABSOLUTE_X},
+        {OpCode::Implied_NOP,      "NOP", Mode::IMPLIED},
+        {OpCode::Immediate_ORA,    "ORA", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_ORA,     "ORA", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_ORA,   "ORA", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_ORA,     "ORA", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_ORA,   "ORA", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_ORA,   "ORA", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_ORA,   "ORA", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_ORA,   "ORA", Mode::INDIRECT_Y},
+        {OpCode::Implied_PHA,      "PHA", Mode::IMPLIED},
+        {OpCode::Implied_PHP,      "PHP", Mode::IMPLIED},
+        {OpCode::Implied_PLA,      "PLA", Mode::IMPLIED},
+        {OpCode::Implied_PLP,      "PLP", Mode::IMPLIED},
+        {OpCode::Accumulator_ROL,  "ROL", Mode::ACCUMULATOR},
+        {OpCode::ZeroPage_ROL,     "ROL", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_ROL,   "ROL", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_ROL,     "ROL", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_ROL,   "ROL", Mode::ABSOLUTE_X},
+        {OpCode::Accumulator_ROR,  "ROR", Mode::ACCUMULATOR},
+        {OpCode::ZeroPage_ROR,     "ROR", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_ROR,   "ROR", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_ROR,     "ROR", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_ROR,   "ROR", Mode::ABSOLUTE_X},
+        {OpCode::Implied_RTI,      "RTI", Mode::IMPLIED},
+        {OpCode::Implied_RTS,      "RTS", Mode::IMPLIED},
+        {OpCode::Immediate_SBC,    "SBC", Mode::IMMEDIATE},
+        {OpCode::ZeroPage_SBC,     "SBC", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_SBC,   "SBC", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_SBC,     "SBC", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_SBC,   "SBC", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_SBC,   "SBC", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_SBC,   "SBC", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_SBC,   "SBC", Mode::INDIRECT_Y},
+        {OpCode::Implied_SEC,      "SEC", Mode::IMPLIED},
+        {OpCode::Implied_SED,      "SED", Mode::IMPLIED},
+        {OpCode::Implied_SEI,      "SEI", Mode::IMPLIED},
+        {OpCode::ZeroPage_STA,     "STA", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_STA,   "STA", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_STA,     "STA", Mode::ABSOLUTE},
+        {OpCode::Absolute_X_STA,   "STA", Mode::ABSOLUTE_X},
+        {OpCode::Absolute_Y_STA,   "STA", Mode::ABSOLUTE_Y},
+        {OpCode::Indirect_X_STA,   "STA", Mode::INDIRECT_X},
+        {OpCode::Indirect_Y_STA,   "STA", Mode::INDIRECT_Y},
+        {OpCode::ZeroPage_STX,     "STX", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_Y_STX,   "STX", Mode::ZERO_PAGE_Y},
+        {OpCode::Absolute_STX,     "STX", Mode::ABSOLUTE},
+        {OpCode::ZeroPage_STY,     "STY", Mode::ZERO_PAGE},
+        {OpCode::ZeroPage_X_STY,   "STY", Mode::ZERO_PAGE_X},
+        {OpCode::Absolute_STY,     "STY", Mode::ABSOLUTE},
+        {OpCode::Implied_TAX,      "TAX", Mode::IMPLIED},
+        {OpCode::Implied_TAY,      "TAY", Mode::IMPLIED},
+        {OpCode::Implied_TSX,      "TSX", Mode::IMPLIED},
+        {OpCode::Implied_TXA,      "TXA", Mode::IMPLIED},
+        {OpCode::Implied_TXS,      "TXS", Mode::IMPLIED},
+        {OpCode::Implied_TYA,      "TYA", Mode::IMPLIED},
+    };
+
+    std::array<Disassembly, 256> table{};
+
+    for (auto const& entry : OPCODES)
+    {
+        table[static_cast<uint8_t>(entry.opCode)] = {entry.mnemonic, entry.mode};
+    }
+
+    return table;
+}
+
+static size_t OperandCount(Mode mode)
+{
+    switch (mode)
+    {
+        case Mode::ABSOLUTE:
+        case Mode::ABSOLUTE_X:
+        case Mode::ABSOLUTE_Y:
+        case Mode::INDIRECT:
+            return 2;
+        case Mode::IMMEDIATE:
+        case Mode::INDIRECT_X:
+        case Mode::INDIRECT_Y:
+        case Mode::RELATIVE:
+        case Mode::ZERO_PAGE:
+        case Mode::ZERO_PAGE_X:
+        case Mode::ZERO_PAGE_Y:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+static std::string FormatOperand(TraceRecord const& record, Mode mode)
+{
+    char buffer[16];
+    uint16_t absolute = (record.operands[1] << 8) | record.operands[0];
+    uint8_t zeroPage = record.operands[0];
+
+    switch (mode)
+    {
+        case Mode::ABSOLUTE:
+            std::snprintf(buffer, sizeof(buffer), "$%04X", absolute);
+            break;
+        case Mode::ABSOLUTE_X:
+            std::snprintf(buffer, sizeof(buffer), "$%04X,X", absolute);
+            break;
+        case Mode::ABSOLUTE_Y:
+            std::snprintf(buffer, sizeof(buffer), "$%04X,Y", absolute);
+            break;
+        case Mode::ACCUMULATOR:
+            return "A";
+        case Mode::IMMEDIATE:
+            std::snprintf(buffer, sizeof(buffer), "#$%02X", zeroPage);
+            break;
+        case Mode::INDIRECT:
+            std::snprintf(buffer, sizeof(buffer), "($%04X)", absolute);
+            break;
+        case Mode::INDIRECT_X:
+            std::snprintf(buffer, sizeof(buffer), "($%02X,X)", zeroPage);
+            break;
+        case Mode::INDIRECT_Y:
+            std::snprintf(buffer, sizeof(buffer), "($%02X),Y", zeroPage);
+            break;
+        case Mode::RELATIVE:
+            std::snprintf(buffer, sizeof(buffer), "$%04X", (uint16_t)(record.programCounter + 2 + (int8_t)zeroPage));
+            break;
+        case Mode::ZERO_PAGE:
+            std::snprintf(buffer, sizeof(buffer), "$%02X", zeroPage);
+            break;
+        case Mode::ZERO_PAGE_X:
+            std::snprintf(buffer, sizeof(buffer), "$%02X,X", zeroPage);
+            break;
+        case Mode::ZERO_PAGE_Y:
+            std::snprintf(buffer, sizeof(buffer), "$%02X,Y", zeroPage);
+            break;
+        default:
+            return "";
+    }
+
+    return buffer;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace file> [output file]\n";
+        return 1;
+    }
+
+    std::ifstream trace(argv[1], std::ios::binary);
+    std::array<char, TRACE_MAGIC.size()> magic;
+    trace.read(magic.data(), magic.size());
+
+    if (trace.fail() || (magic != TRACE_MAGIC))
+    {
+        std::cerr << argv[1] << " is not a CPU trace\n";
+        return 1;
+    }
+
+    FILE* output = (argc > 2) ? std::fopen(argv[2], "w") : stdout;
+
+    if (output == nullptr)
+    {
+        std::cerr << "Unable to open " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::array<Disassembly, 256> const disassemblyTable = CreateDisassemblyTable();
+    TraceRecord record;
+
+    while (trace.read((char*)&record, sizeof(record)))
+    {
+        Disassembly const& disassembly = disassemblyTable[record.opCode];
+        size_t operandCount = OperandCount(disassembly.mode);
+
+        // C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+        char bytes[16];
+        std::snprintf(bytes, sizeof(bytes), "%02X", record.opCode);
+
+        for (size_t i = 0; i < operandCount; ++i)
+        {
+            std::snprintf(bytes + 2 + (i * 3), sizeof(bytes) - 2 - (i * 3), " %02X", record.operands[i]);
+        }
+
+        std::string instruction = std::string(disassembly.mnemonic) + " " + FormatOperand(record, disassembly.mode);
+
+        std::fprintf(output, "%04X  %-8s  %-31s A:%02X X:%02X Y:%02X P:%02X SP:%02X PPU:%3u,%3u CYC:%llu\n",
+                     record.programCounter, bytes, instruction.c_str(), record.accumulator, record.x, record.y,
+                     record.status, record.stackPointer, record.scanline, record.dot, (unsigned long long)record.cycle);
+    }
+
+    if (output != stdout)
+    {
+        std::fclose(output);
+    }
+
+    return 0;
+}